@@ -0,0 +1,79 @@
+#version 400
+
+layout (vertices = 4) out;
+
+in vec3 control_corner[];
+in vec4 control_position[];
+in vec4 control_lowest[];
+in vec4 control_highest[];
+
+uniform vec2 viewport;
+uniform vec2 texels;
+uniform float segment_pixels;
+
+out vec3 evaluation_corner[];
+
+// The level an edge is split to, from its length on screen. It only depends on the two corners of the edge, so patches
+// sharing an edge always agree and leave no cracks between them.
+float EdgeLevel(int first, int second) {
+	// The back is flat and the walls are straight from back to front, only the front follows the depth map.
+	if (control_corner[first].z < 0.5f || control_corner[second].z < 0.5f) {
+		return 1.0f;
+	}
+
+	// Splitting finer than the texels of the depth map adds no detail.
+	float maxLevel = min(max(length((control_corner[second].xy - control_corner[first].xy) * texels), 1.0f),
+	                     float(gl_MaxTessGenLevel));
+
+	vec4 a = control_position[first];
+	vec4 b = control_position[second];
+
+	// An edge reaching behind the camera has no meaningful length on screen.
+	if (a.w <= 0.0f || b.w <= 0.0f) {
+		return maxLevel;
+	}
+
+	float pixels = length((b.xy / b.w - a.xy / a.w) * viewport * 0.5f);
+
+	return clamp(pixels / segment_pixels, 1.0f, maxLevel);
+}
+
+// Whether the box around everything the patch can be displaced to lies wholly outside one side of the view.
+bool IsOffScreen() {
+	vec3 below = vec3(0.0f);
+	vec3 above = vec3(0.0f);
+
+	for (int corner = 0; corner < 4; corner++) {
+		vec4 lowest = control_lowest[corner];
+		vec4 highest = control_highest[corner];
+
+		below += vec3(lessThan(lowest.xyz, -lowest.www)) + vec3(lessThan(highest.xyz, -highest.www));
+		above += vec3(greaterThan(lowest.xyz, lowest.www)) + vec3(greaterThan(highest.xyz, highest.www));
+	}
+
+	return any(equal(below, vec3(8.0f))) || any(equal(above, vec3(8.0f)));
+}
+
+void main() {
+	evaluation_corner[gl_InvocationID] = control_corner[gl_InvocationID];
+
+	if (gl_InvocationID != 0) {
+		return;
+	}
+
+	// A level of zero discards the patch.
+	if (IsOffScreen()) {
+		gl_TessLevelOuter[0] = 0.0f;
+		gl_TessLevelOuter[1] = 0.0f;
+		gl_TessLevelOuter[2] = 0.0f;
+		gl_TessLevelOuter[3] = 0.0f;
+		return;
+	}
+
+	gl_TessLevelOuter[0] = EdgeLevel(0, 3);
+	gl_TessLevelOuter[1] = EdgeLevel(0, 1);
+	gl_TessLevelOuter[2] = EdgeLevel(1, 2);
+	gl_TessLevelOuter[3] = EdgeLevel(3, 2);
+	gl_TessLevelInner[0] = max(gl_TessLevelOuter[1], gl_TessLevelOuter[3]);
+	gl_TessLevelInner[1] = max(gl_TessLevelOuter[0], gl_TessLevelOuter[2]);
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#version 400
+
+layout (quads, fractional_odd_spacing, ccw) in;
+
+in vec3 evaluation_corner[];
+
+uniform mat4 mvp = mat4(1.0f);
+uniform vec2 size;
+uniform float thick_min;
+uniform float depth_max;
+uniform sampler2D depth_map;
+
+out vec3 frag_color;
+
+void main() {
+	// Points on an edge shared by two patches must come out identical in both.
+	precise vec3 corner = mix(mix(evaluation_corner[0], evaluation_corner[1], gl_TessCoord.x),
+	                          mix(evaluation_corner[3], evaluation_corner[2], gl_TessCoord.x), gl_TessCoord.y);
+
+	// Linear filtering averages the four pixels around a corner, as the compiled mesh does for its vertices.
+	float depth = -textureLod(depth_map, corner.xy, 0.0f).r;
+
+	// Shaded by depth on the front and black on the back, blending between the two along the walls.
+	frag_color = vec3(corner.z * (1.0f + depth));
+	gl_Position = mvp * vec4((0.5f - corner.xy) * size, mix(thick_min, depth * depth_max, corner.z), 1.0f);
+}
\ No newline at end of file
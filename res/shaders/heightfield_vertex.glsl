@@ -0,0 +1,27 @@
+#version 400
+
+// A corner of a patch, the texture coordinate in the depth map and whether it lies on the front or the back.
+layout (location = 0) in vec3 in_corner;
+
+uniform mat4 mvp = mat4(1.0f);
+uniform vec2 size;
+uniform float thick_min;
+uniform float depth_max;
+uniform sampler2D depth_map;
+
+out vec3 control_corner;
+out vec4 control_position;
+out vec4 control_lowest;
+out vec4 control_highest;
+
+void main() {
+	vec2 position = (0.5f - in_corner.xy) * size;
+	float depth = -textureLod(depth_map, in_corner.xy, 0.0f).r;
+
+	control_corner = in_corner;
+	control_position = mvp * vec4(position, mix(thick_min, depth * depth_max, in_corner.z), 1.0f);
+
+	// The whole lithophane lies between these depths, bounding what the patch becomes once displaced.
+	control_lowest = mvp * vec4(position, min(thick_min, -depth_max), 1.0f);
+	control_highest = mvp * vec4(position, max(thick_min, 0.0f), 1.0f);
+}
\ No newline at end of file
@@ -1,13 +1,19 @@
 #version 400
 
-layout (location = 0) in vec3 in_position;
-layout (location = 1) in vec3 in_color;
+// Whole 16 bit steps across the bounds of the mesh, the fourth component is one on the front and zero on the back.
+layout (location = 0) in vec4 in_position;
 
 uniform mat4 mvp = mat4(1.0f);
+uniform vec3 quant_offset = vec3(0.0f);
+uniform vec3 quant_scale = vec3(1.0f);
+uniform float depth_max = 1.0f;
 
 out vec3 frag_color;
 
 void main() {
-	frag_color = in_color;
-    gl_Position = mvp * vec4(in_position, 1.0f);
+	vec3 position = quant_offset + in_position.xyz * quant_scale;
+
+	// The front is white at its top and black at its full depth below it, the back is black.
+	frag_color = vec3(in_position.w * (1.0f + position.z / depth_max));
+    gl_Position = mvp * vec4(position, 1.0f);
 }
\ No newline at end of file
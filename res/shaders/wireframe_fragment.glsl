@@ -0,0 +1,18 @@
+#version 400
+
+in vec3 edge_color;
+in vec3 edge_barycentric;
+out vec4 out_color;
+
+// The colour edges are drawn in, the accent of the interface, and their width in pixels.
+const vec3 line_color = vec3(0.26f, 0.59f, 0.98f);
+const float line_width = 1.0f;
+
+void main() {
+	// The distance to each edge in pixels, from how fast the coordinates change across the screen.
+	vec3 pixels = edge_barycentric / max(fwidth(edge_barycentric), vec3(1e-6f));
+	float edge = min(min(pixels.x, pixels.y), pixels.z);
+
+	// Edges fade out over one pixel to keep them smooth.
+	out_color = vec4(mix(line_color, edge_color, smoothstep(line_width - 0.5f, line_width + 0.5f, edge)), 1.0f);
+}
\ No newline at end of file
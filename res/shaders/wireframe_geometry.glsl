@@ -0,0 +1,23 @@
+#version 400
+
+layout (triangles) in;
+layout (triangle_strip, max_vertices = 3) out;
+
+in vec3 frag_color[];
+
+out vec3 edge_color;
+out vec3 edge_barycentric;
+
+void main() {
+	for (int corner = 0; corner < 3; corner++) {
+		// One at its own corner and zero along the opposite edge, so the smallest component measures the nearest edge.
+		edge_barycentric = vec3(0.0f);
+		edge_barycentric[corner] = 1.0f;
+
+		edge_color = frag_color[corner];
+		gl_Position = gl_in[corner].gl_Position;
+		EmitVertex();
+	}
+
+	EndPrimitive();
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "batch.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "compilation.h"
+#include "declarations/config.h"
+#include "declarations/constants.h"
+#include "exporting.h"
+#include "imagecache.h"
+#include "importing.h"
+#include "meshcache.h"
+#include "storage.h"
+
+// Parse the value of a length option, which must be a positive number of millimetres.
+bool ParseLength(const char* text, float& value)
+{
+	char* end = nullptr;
+	const float parsed = std::strtof(text, &end);
+
+	if (end == text || *end != '\0' || !std::isfinite(parsed) || parsed <= 0.0F) {
+		return false;
+	}
+
+	value = parsed;
+
+	return true;
+}
+
+// Decode the source of a job and size the model to its aspect ratio, as the interface does on import.
+bool DecodeSource(const char* imagePath, Image& image, Config& config)
+{
+	if (!LoadImageFile(imagePath, image)) {
+		std::cerr << "Failed to load the image \"" << imagePath << "\".\n";
+		return false;
+	}
+
+	const ImageView view = GetImageView(image, &config);
+	config.sliderHeight = config.sliderWidth * view.height / view.width;
+
+	return true;
+}
+
+// Slice one image into a resin printer layer archive, which needs only its depth map.
+bool RunSliceJob(const char* imagePath, const char* outputPath, Config config)
+{
+	Image image;
+
+	if (!DecodeSource(imagePath, image, config)) {
+		return false;
+	}
+
+	const ImageView view = GetImageView(image, &config);
+	std::vector<float> depthMap;
+	ComputeDepthMap(depthMap, &config, view);
+
+	ExportProgress progress;
+	std::string error;
+
+	return WriteSlices(outputPath, depthMap, view.width, view.height, &config, progress, error);
+}
+
+// Compile and export one image, skipping every step the cache already holds the result of.
+bool RunJob(const char* imagePath, const char* outputPath, Config config, const bool ascii, const bool optimize,
+            MeshCache& meshCache)
+{
+	// Extensions are matched without regard to case, as for the other formats.
+	std::string extension = std::filesystem::path(outputPath).extension().string();
+	std::ranges::transform(extension, extension.begin(), [](const unsigned char c) { return std::tolower(c); });
+
+	if (extension == ".zip") {
+		return RunSliceJob(imagePath, outputPath, config);
+	}
+
+	std::string sourceKey;
+	MeshSettings settings;
+	Image image;
+
+	// An unchanged file requested with the same settings before is resolved without decoding it.
+	if (!BuildImageKey(imagePath, sourceKey) || !meshCache.LookupSource(sourceKey, &config, settings)) {
+		if (!DecodeSource(imagePath, image, config)) {
+			return false;
+		}
+
+		settings = GetMeshSettings(&config, GetImageView(image, &config));
+		meshCache.StoreSource(sourceKey, &config, settings);
+	}
+
+	if (meshCache.LoadExport(settings, outputPath, ascii, optimize)) {
+		return true;
+	}
+
+	Model model;
+
+	if (!meshCache.LoadModel(settings, model)) {
+		// The mesh may have been evicted since the source was resolved, in which case it is decoded after all.
+		if (image.data == nullptr && !DecodeSource(imagePath, image, config)) {
+			return false;
+		}
+
+		const ImageView view = GetImageView(image, &config);
+		std::vector<float> depthMap;
+
+		ComputeDepthMap(depthMap, &config, view);
+		CompileModel(model, &config, view, depthMap);
+		model.settings = settings;
+
+		ExportProgress cacheProgress;
+		meshCache.StoreModel(model, cacheProgress);
+	}
+
+	ExportProgress progress;
+	std::string error;
+
+	if (!WriteModel(outputPath, model, ascii, optimize, progress, error)) {
+		return false;
+	}
+
+	meshCache.StoreExport(settings, outputPath, ascii, optimize);
+
+	return true;
+}
+
+int RunBatch(const int argc, char* argv[])
+{
+	Config config;
+	bool ascii = false;
+	bool optimize = false;
+	int argument = 0;
+
+	for (; argument < argc && strncmp(argv[argument], "--", 2) == 0; argument++) {
+		const char* option = argv[argument];
+
+		if (strcmp(option, "--ascii") == 0) {
+			ascii = true;
+			continue;
+		}
+
+		if (strcmp(option, "--optimize") == 0) {
+			optimize = true;
+			continue;
+		}
+
+		float* value = nullptr;
+
+		if (strcmp(option, "--width") == 0) {
+			value = &config.sliderWidth;
+		} else if (strcmp(option, "--min") == 0) {
+			value = &config.sliderThickMin;
+		} else if (strcmp(option, "--max") == 0) {
+			value = &config.sliderThickMax;
+		} else if (strcmp(option, "--pixel") == 0) {
+			value = &config.slicePixelSize;
+		} else if (strcmp(option, "--layer") == 0) {
+			value = &config.sliceLayerHeight;
+		}
+
+		if (value == nullptr || ++argument == argc) {
+			std::cerr << "Unknown or incomplete option \"" << option << "\".\n";
+			return 1;
+		}
+
+		if (!ParseLength(argv[argument], *value)) {
+			std::cerr << "Option \"" << option << "\" needs a positive number, not \"" << argv[argument] << "\".\n";
+			return 1;
+		}
+	}
+
+	if (argument == argc || (argc - argument) % 2 != 0) {
+		std::cerr << "Usage: lithogen --batch [--width <mm>] [--min <mm>] [--max <mm>] [--pixel <mm>] [--layer <mm>] "
+		             "[--ascii] [--optimize] <image> <output> [<image> <output> ...]\n";
+		return 1;
+	}
+
+	MeshCache meshCache(MESH_CACHE_DISK_CAP);
+	meshCache.SetCacheDirectory(GetCacheDirectory());
+
+	int failures = 0;
+
+	for (; argument < argc; argument += 2) {
+		if (!RunJob(argv[argument], argv[argument + 1], config, ascii, optimize, meshCache)) {
+			failures++;
+		}
+	}
+
+	std::cout << "Mesh cache hit rates:\n" << meshCache.GetStats() << '\n';
+
+	return failures == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,9 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+// Compile and export images without opening a window, for scripted and repeated jobs. The arguments following --batch
+// are pairs of image and output paths, optionally preceded by options applied to every pair:
+//     --width <mm>  --min <mm>  --max <mm>  --pixel <mm>  --layer <mm>  --ascii
+// Outputs ending in .zip are sliced into resin printer layers rather than compiled.
+// Returns the exit code of the process, which is non-zero if any job failed.
+int RunBatch(int argc, char* argv[]);
\ No newline at end of file
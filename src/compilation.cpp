@@ -1,19 +1,18 @@
 // SPDX-License-Identifier: GPL-3.0
 #include "compilation.h"
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <iostream>
-#include <microstl.h>
-#include <thread>
+#include <iterator>
 #include <vector>
+#include "hashing.h"
 
-float GetDepth(const int index, const Config* config, const Image& image)
+float GetDepth(const stbi_uc* pixel, const Config* config)
 {
-	const int rgbaIndex = index * 4;
-
 	// Calculate the grayscale out of the RGB values, weighted by the config.
-	const float grayScale = config->sliderGsPref[0] * image.data[rgbaIndex] +
-	                        config->sliderGsPref[1] * image.data[rgbaIndex + 1] +
-	                        config->sliderGsPref[2] * image.data[rgbaIndex + 2];
+	const float grayScale =
+		config->sliderGsPref[0] * pixel[0] + config->sliderGsPref[1] * pixel[1] + config->sliderGsPref[2] * pixel[2];
 
 	// TODO: Implement alpha slider (config->sliderGsPref[3]) to scale the alpha between inverted and not.
 
@@ -21,19 +20,115 @@ float GetDepth(const int index, const Config* config, const Image& image)
 	float depth = 1 - grayScale / 255;
 
 	// Fully transparent pixels are made thinnest and opaque is unmodified.
-	depth *= image.data[rgbaIndex + 3] / 255.0F;
+	depth *= pixel[3] / 255.0F;
 
 	// Make the output negative to ensure the mesh builds in the correct direction.
 	return -depth;
 }
 
-void CompileModel(Model& model, const Config* config, const Image& image)
+ImageView GetImageView(const Image& image, const Config* config)
+{
+	ImageView view;
+	view.data = image.data;
+	view.width = image.width;
+	view.height = image.height;
+	view.rowPitch = static_cast<size_t>(image.width) * 4;
+
+	if (!config->roiEnabled) {
+		return view;
+	}
+
+	// Convert the normalised selection into whole pixels, never letting it collapse below a single pixel.
+	const int left = std::clamp(static_cast<int>(config->roi[0] * image.width), 0, image.width - 1);
+	const int top = std::clamp(static_cast<int>(config->roi[1] * image.height), 0, image.height - 1);
+	const int right = std::clamp(static_cast<int>(std::ceil(config->roi[2] * image.width)), left + 1, image.width);
+	const int bottom = std::clamp(static_cast<int>(std::ceil(config->roi[3] * image.height)), top + 1, image.height);
+
+	view.x = left;
+	view.y = top;
+	view.width = right - left;
+	view.height = bottom - top;
+
+	return view;
+}
+
+void ComputeDepthMap(std::vector<float>& depthMap, const Config* config, const ImageView& view)
+{
+	depthMap.resize(static_cast<size_t>(view.width) * view.height);
+
+	// Only the rows and columns inside the view are ever read.
+	for (int row = 0; row < view.height; row++) {
+		const stbi_uc* pixel = view.GetPixel(0, row);
+		float* depth = depthMap.data() + static_cast<size_t>(row) * view.width;
+
+		for (int column = 0; column < view.width; column++, pixel += 4) {
+			depth[column] = GetDepth(pixel, config);
+		}
+	}
+}
+
+MeshSettings GetMeshSettings(const Config* config, const ImageView& view)
+{
+	MeshSettings settings;
+	settings.sourceHash = HashImageView(view);
+	settings.sourceWidth = view.width;
+	settings.sourceHeight = view.height;
+	settings.meshType = config->dropdownMesh;
+	settings.roiEnabled = config->roiEnabled ? 1 : 0;
+	std::copy_n(config->roi, 4, settings.roi);
+	settings.width = config->sliderWidth;
+	settings.height = config->sliderHeight;
+	settings.thickMin = config->sliderThickMin;
+	settings.thickMax = config->sliderThickMax;
+	std::copy_n(config->sliderGsPref, 4, settings.gsPref);
+
+	return settings;
+}
+
+void ApplyMeshSettings(Config* config, const MeshSettings& settings)
+{
+	// A mesh file may hold anything, so every value is brought within what the interface itself allows. Values that
+	// are not numbers at all keep the current setting.
+	const auto restore = [](float& target, const float value, const float min, const float max) {
+		if (std::isfinite(value)) {
+			target = std::clamp(value, min, max);
+		}
+	};
+
+	const int meshTypeCount = static_cast<int>(std::size(config->dropdownMeshTypes));
+	config->dropdownMesh = std::clamp(settings.meshType, 0, meshTypeCount - 1);
+
+	config->roiEnabled = settings.roiEnabled != 0;
+
+	for (int edge = 0; edge < 4; edge++) {
+		restore(config->roi[edge], settings.roi[edge], 0.0F, 1.0F);
+	}
+
+	// A selection that is inside out or empty can not be compiled, the whole image is used instead.
+	if (config->roi[2] <= config->roi[0] || config->roi[3] <= config->roi[1]) {
+		const Config defaults;
+		config->roiEnabled = false;
+		std::copy_n(defaults.roi, 4, config->roi);
+	}
+
+	restore(config->sliderWidth, settings.width, SLIDER_WIDTH_MIN, SLIDER_WIDTH_MAX);
+	restore(config->sliderHeight, settings.height, SLIDER_HEIGHT_MIN, SLIDER_HEIGHT_MAX);
+	restore(config->sliderThickMin, settings.thickMin, SLIDER_THICK_MIN, SLIDER_THICK_MAX);
+	restore(config->sliderThickMax, settings.thickMax, SLIDER_THICK_MIN, SLIDER_THICK_MAX);
+	config->sliderThickMax = std::max(config->sliderThickMin, config->sliderThickMax);
+
+	for (int channel = 0; channel < 4; channel++) {
+		restore(config->sliderGsPref[channel], settings.gsPref[channel], 0.0F, 1.0F);
+	}
+}
+
+void CompileModel(Model& model, const Config* config, const ImageView& view, const std::vector<float>& depthMap)
 {
 	std::cout << "Compiling mesh...\n";
 	std::flush(std::cout);
 
 	const auto startTime = std::chrono::high_resolution_clock::now();
-	const int pixelCount = image.width * image.height;
+	const int pixelCount = view.width * view.height;
 
 	// Reset the model to blank before we begin editing. Maybe we can avoid allocated the model initially if we do it
 	// here, or avoid the double allocation some other way.
@@ -45,15 +140,15 @@ void CompileModel(Model& model, const Config* config, const Image& image)
 	// - Indices prediction is simply 6 per pixel as each pixel is two triangles. This is doubled for the back panel
 	// with an extra 6 for each edge pixel to connect them.
 
-	const size_t frontVertexCount = (image.width + 1) * (image.height + 1);
+	const size_t frontVertexCount = (view.width + 1) * (view.height + 1);
 	const size_t frontIndexCount = pixelCount * 6;
 
 	model.vertices.resize(frontVertexCount * 2);
-	model.indices.reserve(frontIndexCount * 2 + ((image.width + image.height) * 2) * 6);
+	model.indices.reserve(frontIndexCount * 2 + ((view.width + view.height) * 2) * 6);
 
 	// This will calculate the size of each pixel to create the target size. As aspect ratio is enforced, we only
 	// need to calculate the size of one side of the pixel as they will be equal.
-	const float pixelSize = config->sliderWidth / image.width;
+	const float pixelSize = config->sliderWidth / view.width;
 
 	// The min depth is space back from zero, the max depth is forward from zero. To avoid going above the max depth the
 	// min depth needs to be taken away from it.
@@ -67,25 +162,24 @@ void CompileModel(Model& model, const Config* config, const Image& image)
 	size_t nextIndex = 0;
 
 	for (int pixelIndex = 0; pixelIndex < pixelCount; pixelIndex++) {
-		const int row = pixelIndex / image.width;
+		const int row = pixelIndex / view.width;
 
 		// Gather the current state of the pixel.
 		const bool firstRow = row == 0;
-		const bool lastRow = row == image.height - 1;
-		const bool firstInRow = pixelIndex - row * image.width == 0;
-		const bool lastInRow = pixelIndex - row * image.width == image.width - 1;
+		const bool lastRow = row == view.height - 1;
+		const bool firstInRow = pixelIndex - row * view.width == 0;
+		const bool lastInRow = pixelIndex - row * view.width == view.width - 1;
 
 		// === Vertex Generation ===
 
-		const float depth = GetDepth(pixelIndex, config, image);
+		const float depth = depthMap[pixelIndex];
 
 		if (firstInRow) {
 			column = 0;
 
 			// Calculate the average for left side edge vertices, leaving the top left and bottom right points
 			// unmodified.
-			const float firstDepth =
-				!firstRow ? (depth + GetDepth(pixelIndex - image.width, config, image)) / 2 : depth;
+			const float firstDepth = !firstRow ? (depth + depthMap[pixelIndex - view.width]) / 2 : depth;
 
 			// The first vertex of every row.
 			const glm::vec3 firstVert(-(column * pixelSize), -row * pixelSize, firstDepth * depthMax);
@@ -98,8 +192,8 @@ void CompileModel(Model& model, const Config* config, const Image& image)
 			if (lastRow) {
 				const glm::vec3 secondVert(-(column * pixelSize), (-row - 1) * pixelSize, depth * depthMax);
 
-				model.vertices[nextIndex + (image.width + 1)] = Vertex(secondVert, glm::vec3(1 - -depth));
-				model.vertices[frontVertexCount + nextIndex + (image.width + 1)] =
+				model.vertices[nextIndex + (view.width + 1)] = Vertex(secondVert, glm::vec3(1 - -depth));
+				model.vertices[frontVertexCount + nextIndex + (view.width + 1)] =
 					Vertex(glm::vec3(secondVert.x, secondVert.y, depthMin), glm::vec3(0));
 			}
 
@@ -111,15 +205,14 @@ void CompileModel(Model& model, const Config* config, const Image& image)
 		if (lastInRow && firstRow) {
 			secondDepth = depth; // For the top right pixel.
 		} else if (firstRow) {
-			secondDepth = (depth + GetDepth(pixelIndex + 1, config, image)) / 2; // For normal top pixels.
+			secondDepth = (depth + depthMap[pixelIndex + 1]) / 2; // For normal top pixels.
 		} else if (lastInRow) {
-			secondDepth = (depth + GetDepth(pixelIndex - image.width, config, image)) / 2; // For normal right pixels.
+			secondDepth = (depth + depthMap[pixelIndex - view.width]) / 2; // For normal right pixels.
 		} else {
 			// For normal pixels.
-			secondDepth =
-				(depth + GetDepth(pixelIndex + 1, config, image) + GetDepth(pixelIndex - image.width, config, image) +
-			     GetDepth(pixelIndex - image.width + 1, config, image)) /
-				4;
+			secondDepth = (depth + depthMap[pixelIndex + 1] + depthMap[pixelIndex - view.width] +
+			               depthMap[pixelIndex - view.width + 1]) /
+			              4;
 		}
 
 		// The most common type of vertex.
@@ -132,13 +225,13 @@ void CompileModel(Model& model, const Config* config, const Image& image)
 		// Last row includes creating the final row in parallel.
 		if (lastRow) {
 			// Calculate the average for the last row pixels, leaving the bottom right pixel alone.
-			const float thirdDepth = !lastInRow ? (depth + GetDepth(pixelIndex + 1, config, image)) / 2 : depth;
+			const float thirdDepth = !lastInRow ? (depth + depthMap[pixelIndex + 1]) / 2 : depth;
 
 			const glm::vec3 fourthVert(-(column * pixelSize + pixelSize), (-row - 1) * pixelSize,
 			                           thirdDepth * depthMax);
 
-			model.vertices[nextIndex + (image.width + 1)] = Vertex(fourthVert, glm::vec3(1 - -thirdDepth));
-			model.vertices[frontVertexCount + nextIndex + (image.width + 1)] =
+			model.vertices[nextIndex + (view.width + 1)] = Vertex(fourthVert, glm::vec3(1 - -thirdDepth));
+			model.vertices[frontVertexCount + nextIndex + (view.width + 1)] =
 				Vertex(glm::vec3(fourthVert.x, fourthVert.y, depthMin), glm::vec3(0));
 		}
 
@@ -151,89 +244,90 @@ void CompileModel(Model& model, const Config* config, const Image& image)
 		// - Adding the row will ensure the indices does not attempt to wrap one side of the plane to the other
 		// through skipping the triangles that would cause this.
 		// - The numbers added are the relative positions of the surrounding vertex indices.
+		// - Every triangle is wound counter-clockwise seen from outside the mesh.
 
 		// Invert the triangles every other column and invert that every other row.
 		if (((pixelIndex ^ row) & 1) == 0) {
 			// Front Panel
 			model.indices.push_back(pixelIndex + row + 0);
-			model.indices.push_back(pixelIndex + row + (1 + (image.width + 1)));
-			model.indices.push_back(pixelIndex + row + (0 + (image.width + 1)));
+			model.indices.push_back(pixelIndex + row + (0 + (view.width + 1)));
+			model.indices.push_back(pixelIndex + row + (1 + (view.width + 1)));
 
 			model.indices.push_back(pixelIndex + row + 1);
-			model.indices.push_back(pixelIndex + row + (1 + (image.width + 1)));
 			model.indices.push_back(pixelIndex + row + 0);
+			model.indices.push_back(pixelIndex + row + (1 + (view.width + 1)));
 
 			// Back Panel
 			model.indices.push_back(frontVertexCount + pixelIndex + row + 0);
-			model.indices.push_back(frontVertexCount + pixelIndex + row + (0 + (image.width + 1)));
 			model.indices.push_back(frontVertexCount + pixelIndex + row + 1);
+			model.indices.push_back(frontVertexCount + pixelIndex + row + (0 + (view.width + 1)));
 
 			model.indices.push_back(frontVertexCount + pixelIndex + row + 1);
-			model.indices.push_back(frontVertexCount + pixelIndex + row + (0 + (image.width + 1)));
-			model.indices.push_back(frontVertexCount + pixelIndex + row + (1 + (image.width + 1)));
+			model.indices.push_back(frontVertexCount + pixelIndex + row + (1 + (view.width + 1)));
+			model.indices.push_back(frontVertexCount + pixelIndex + row + (0 + (view.width + 1)));
 		} else {
 			// Front Panel
-			model.indices.push_back(pixelIndex + row + (1 + (image.width + 1)));
-			model.indices.push_back(pixelIndex + row + (0 + (image.width + 1)));
+			model.indices.push_back(pixelIndex + row + (1 + (view.width + 1)));
 			model.indices.push_back(pixelIndex + row + 1);
+			model.indices.push_back(pixelIndex + row + (0 + (view.width + 1)));
 
-			model.indices.push_back(pixelIndex + row + (0 + (image.width + 1)));
-			model.indices.push_back(pixelIndex + row + 0);
+			model.indices.push_back(pixelIndex + row + (0 + (view.width + 1)));
 			model.indices.push_back(pixelIndex + row + 1);
+			model.indices.push_back(pixelIndex + row + 0);
 
 			// Back Panel
 			model.indices.push_back(frontVertexCount + pixelIndex + row + 1);
+			model.indices.push_back(frontVertexCount + pixelIndex + row + (1 + (view.width + 1)));
 			model.indices.push_back(frontVertexCount + pixelIndex + row + 0);
-			model.indices.push_back(frontVertexCount + pixelIndex + row + (1 + (image.width + 1)));
 
 			model.indices.push_back(frontVertexCount + pixelIndex + row + 0);
-			model.indices.push_back(frontVertexCount + pixelIndex + row + (0 + (image.width + 1)));
-			model.indices.push_back(frontVertexCount + pixelIndex + row + (1 + (image.width + 1)));
+			model.indices.push_back(frontVertexCount + pixelIndex + row + (1 + (view.width + 1)));
+			model.indices.push_back(frontVertexCount + pixelIndex + row + (0 + (view.width + 1)));
 		}
 
 		if (firstRow) {
 			// Implement top triangles.
 			model.indices.push_back(pixelIndex + row + 0);
-			model.indices.push_back(frontVertexCount + pixelIndex + row + 0);
 			model.indices.push_back(frontVertexCount + pixelIndex + row + 1);
+			model.indices.push_back(frontVertexCount + pixelIndex + row + 0);
 
 			model.indices.push_back(pixelIndex + row + 1);
-			model.indices.push_back(pixelIndex + row + 0);
 			model.indices.push_back(frontVertexCount + pixelIndex + row + 1);
+			model.indices.push_back(pixelIndex + row + 0);
 		}
 
 		if (firstInRow) {
 			// Implement left triangles.
-			model.indices.push_back(pixelIndex + image.width + 1 + row);
-			model.indices.push_back(frontVertexCount + pixelIndex + image.width + 1 + row);
+			model.indices.push_back(pixelIndex + view.width + 1 + row);
 			model.indices.push_back(frontVertexCount + pixelIndex + row);
+			model.indices.push_back(frontVertexCount + pixelIndex + view.width + 1 + row);
 
-			model.indices.push_back(pixelIndex + image.width + 1 + row);
-			model.indices.push_back(frontVertexCount + pixelIndex + row);
+			model.indices.push_back(pixelIndex + view.width + 1 + row);
 			model.indices.push_back(pixelIndex + row);
+			model.indices.push_back(frontVertexCount + pixelIndex + row);
 		}
 
 		if (lastInRow) {
 			// Implement right triangles, as we create two vertices at the start of each row, we need to shift this
 			// across one.
-			model.indices.push_back(frontVertexCount + pixelIndex + image.width + 1 + row + 1);
-			model.indices.push_back(pixelIndex + image.width + 1 + row + 1);
+			model.indices.push_back(frontVertexCount + pixelIndex + view.width + 1 + row + 1);
 			model.indices.push_back(frontVertexCount + pixelIndex + row + 1);
+			model.indices.push_back(pixelIndex + view.width + 1 + row + 1);
 
 			model.indices.push_back(pixelIndex + row + 1);
+			model.indices.push_back(pixelIndex + view.width + 1 + row + 1);
 			model.indices.push_back(frontVertexCount + pixelIndex + row + 1);
-			model.indices.push_back(pixelIndex + image.width + 1 + row + 1);
 		}
 
 		if (lastRow) {
 			// Implement bottom triangles, need to push the pixel index to the bottom vertex row.
-			model.indices.push_back(frontVertexCount + pixelIndex + image.width + 1 + row + 0);
-			model.indices.push_back(pixelIndex + image.width + 1 + row + 0);
-			model.indices.push_back(frontVertexCount + pixelIndex + image.width + 1 + row + 1);
+			model.indices.push_back(frontVertexCount + pixelIndex + view.width + 1 + row + 0);
+			model.indices.push_back(frontVertexCount + pixelIndex + view.width + 1 + row + 1);
+			model.indices.push_back(pixelIndex + view.width + 1 + row + 0);
 
-			model.indices.push_back(frontVertexCount + pixelIndex + image.width + 1 + row + 1);
-			model.indices.push_back(pixelIndex + image.width + 1 + row + 0);
-			model.indices.push_back(pixelIndex + image.width + 1 + row + 1);
+			model.indices.push_back(frontVertexCount + pixelIndex + view.width + 1 + row + 1);
+			model.indices.push_back(pixelIndex + view.width + 1 + row + 1);
+			model.indices.push_back(pixelIndex + view.width + 1 + row + 0);
 		}
 
 		column++;
@@ -267,55 +361,4 @@ void CompileModel(Model& model, const Config* config, const Image& image)
 	for (int i = 0; i < model.indices.size(); i++) {
 	    std::cout << i / 6 + 1 << " = " << model.indices[i] << '\n';
 	} */
-}
-
-struct CustomMeshProvider : microstl::Writer::Provider {
-	const Model& model;
-	bool ascii = false; // Write out the STL in ASCII text format as opposed to binary.
-	bool clearNormals = true; // Ignore the n value below.
-
-	CustomMeshProvider(const Model& m) : model(m) {}
-
-	bool asciiMode() override
-	{
-		return ascii;
-	}
-	bool nullifyNormals() override
-	{
-		return clearNormals;
-	}
-
-	size_t getFacetCount() override
-	{
-		return model.indices.size() / 3;
-	}
-
-	void getFacet(size_t index, float v1[3], float v2[3], float v3[3], float n[3]) override
-	{
-		index *= 3;
-
-		v1[0] = model.vertices[model.indices[index]].position.x;
-		v1[1] = model.vertices[model.indices[index]].position.y;
-		v1[2] = model.vertices[model.indices[index]].position.z;
-		v2[0] = model.vertices[model.indices[index + 1]].position.x;
-		v2[1] = model.vertices[model.indices[index + 1]].position.y;
-		v2[2] = model.vertices[model.indices[index + 1]].position.z;
-		v3[0] = model.vertices[model.indices[index + 2]].position.x;
-		v3[1] = model.vertices[model.indices[index + 2]].position.y;
-		v3[2] = model.vertices[model.indices[index + 2]].position.z;
-	}
-};
-
-void WriteModel(const char* filePath, const Model& model)
-{
-	using namespace microstl;
-
-	CustomMeshProvider provider(model);
-
-	if (const Result result = Writer::writeStlFile(filePath, provider); result != Result::Success) {
-		std::cerr << "Failed to write stl file!\n";
-	}
-
-	std::cout << "Written mesh to disk as \"" << filePath << "\".\n";
-	std::flush(std::cout);
 }
\ No newline at end of file
@@ -1,8 +1,16 @@
 // SPDX-License-Identifier: GPL-3.0
 #pragma once
 
+#include <vector>
 #include "declarations/config.h"
 #include "declarations/structures.h"
 
-void CompileModel(Model& model, const Config* config, const Image& image);
-void WriteModel(const char* filePath, const Model& model);
\ No newline at end of file
+// A view of the whole image, or only the region of interest when one is selected.
+ImageView GetImageView(const Image& image, const Config* config);
+// Convert every pixel of the view into a normalised depth, weighted by the grayscale preference.
+void ComputeDepthMap(std::vector<float>& depthMap, const Config* config, const ImageView& view);
+// Snapshot the settings the view is compiled with, including a hash of its pixels.
+MeshSettings GetMeshSettings(const Config* config, const ImageView& view);
+// Restore the settings of a reopened mesh into the interface.
+void ApplyMeshSettings(Config* config, const MeshSettings& settings);
+void CompileModel(Model& model, const Config* config, const ImageView& view, const std::vector<float>& depthMap);
\ No newline at end of file
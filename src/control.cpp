@@ -2,19 +2,24 @@
 #include "control.h"
 #include "GLFW/glfw3.h"
 #include "glad/gl.h"
+#include "imgui.h"
 
 void FramebufferSizeCallback(GLFWwindow* window, const int width, const int height)
 {
 	const auto* data = static_cast<glfwUserData*>(glfwGetWindowUserPointer(window));
 	// Recalculate viewport size when the window is resized.
 	data->render->CalcViewport(width, height);
+	data->render->RequestRedraw();
 }
 
 void KeyCallback(GLFWwindow* window, const int key, const int scancode, const int action, const int mods)
 {
 	const auto* data = static_cast<glfwUserData*>(glfwGetWindowUserPointer(window));
 
-	if (!data->render->entity.HasModel()) {
+	// Any input may change the interface, so a frame is drawn even when the model is not affected.
+	data->render->RequestRedraw();
+
+	if (!data->render->HasModel()) {
 		return;
 	}
 
@@ -22,7 +27,6 @@ void KeyCallback(GLFWwindow* window, const int key, const int scancode, const in
 		data->render->camera.ResetRotation();
 	} else if (key == GLFW_KEY_W && action == GLFW_PRESS) {
 		data->config->drawWireframe = !data->config->drawWireframe;
-		data->render->UpdateWireframe();
 	}
 }
 
@@ -30,7 +34,9 @@ void CursorPosCallback(GLFWwindow* window, const double x, const double y)
 {
 	auto* data = static_cast<glfwUserData*>(glfwGetWindowUserPointer(window));
 
-	if (!data->render->entity.HasModel()) {
+	data->render->RequestRedraw();
+
+	if (!data->render->HasModel()) {
 		return;
 	}
 
@@ -46,11 +52,13 @@ void CursorPosCallback(GLFWwindow* window, const double x, const double y)
 	data->cursorWithinViewport =
 		width - x < data->render->GetViewportWidth() && height - y < data->render->GetViewportHeight();
 
-	// Is left mouse down and is the cursor within the viewport.
-	if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GL_TRUE && data->cursorWithinViewport) {
+	// Is left mouse down, is the cursor within the viewport and not over an interface window inside it.
+	if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GL_TRUE && data->cursorWithinViewport &&
+	    !ImGui::GetIO().WantCaptureMouse) {
 		// Apply the difference between the previous and current mouse location to the camera's rotation.
 		data->render->camera.RotateHorizontal((x - previousX) / 20);
 		data->render->camera.RotateVertical((y - previousY) / 20);
+		data->render->NotifyCameraMoved();
 	}
 
 	previousX = x;
@@ -61,8 +69,42 @@ void ScrollCallback(GLFWwindow* window, const double x, const double y)
 {
 	const auto* data = static_cast<glfwUserData*>(glfwGetWindowUserPointer(window));
 
+	data->render->RequestRedraw();
+
 	// Move 4mm per scroll.
-	if (data->render->entity.HasModel() && data->cursorWithinViewport) {
+	if (data->render->HasModel() && data->cursorWithinViewport) {
 		data->render->camera.Zoom(y * 4);
+		data->render->NotifyCameraMoved();
 	}
+}
+
+void DropCallback(GLFWwindow* window, const int count, const char** paths)
+{
+	const auto* data = static_cast<glfwUserData*>(glfwGetWindowUserPointer(window));
+
+	data->render->RequestRedraw();
+
+	// Only a single image can be mounted, so the first of several dropped files is used.
+	if (count > 0) {
+		data->importer->Start(paths[0]);
+	}
+}
+
+void MouseButtonCallback(GLFWwindow* window, const int button, const int action, const int mods)
+{
+	const auto* data = static_cast<glfwUserData*>(glfwGetWindowUserPointer(window));
+	data->render->RequestRedraw();
+}
+
+void CharCallback(GLFWwindow* window, const unsigned int codepoint)
+{
+	const auto* data = static_cast<glfwUserData*>(glfwGetWindowUserPointer(window));
+	data->render->RequestRedraw();
+}
+
+void WindowRefreshCallback(GLFWwindow* window)
+{
+	// The contents of the window were lost, such as after being uncovered.
+	const auto* data = static_cast<glfwUserData*>(glfwGetWindowUserPointer(window));
+	data->render->RequestRedraw();
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #pragma once
 
 #include "declarations/config.h"
+#include "importing.h"
 #include "renderer/render.h"
 
 struct glfwUserData {
@@ -9,11 +10,17 @@ struct glfwUserData {
 
 	Config* config;
 	Render* render;
+	ImageImporter* importer;
 
-	glfwUserData(Config* config, Render* render) : config(config), render(render) {}
+	glfwUserData(Config* config, Render* render, ImageImporter* importer) :
+		config(config), render(render), importer(importer) {}
 };
 
 void FramebufferSizeCallback(GLFWwindow* window, int width, int height);
 void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
 void CursorPosCallback(GLFWwindow* window, double x, double y);
-void ScrollCallback(GLFWwindow* window, double x, double y);
\ No newline at end of file
+void ScrollCallback(GLFWwindow* window, double x, double y);
+void DropCallback(GLFWwindow* window, int count, const char** paths);
+void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
+void CharCallback(GLFWwindow* window, unsigned int codepoint);
+void WindowRefreshCallback(GLFWwindow* window);
\ No newline at end of file
@@ -1,6 +1,8 @@
 // SPDX-License-Identifier: GPL-3.0
 #pragma once
 
+#include <string>
+
 // Min max values for the sliders.
 // Normalised float value sliders are always between 0 and 1.
 #define SLIDER_WIDTH_MIN 1.0F
@@ -9,6 +11,8 @@
 #define SLIDER_HEIGHT_MAX 2000.0F
 #define SLIDER_THICK_MIN 0.001F
 #define SLIDER_THICK_MAX 20.0F
+#define SLIDER_SLICE_MIN 0.01F
+#define SLIDER_SLICE_MAX 0.2F
 
 // The format for sliders.
 #define SLIDER_FLOAT_FORMAT_MM "%.3F mm"
@@ -19,6 +23,12 @@ struct Config {
 	bool drawSource = true;
 	bool drawPreview = true;
 	bool drawWireframe = false;
+	bool drawHeightField = false;
+	bool drawReducedWhileMoving = true;
+	bool cacheSpill = false;
+	bool cacheMeshes = true;
+	bool exportAsciiStl = false;
+	bool exportOptimized = false;
 
 	// Side Panel
 	float sliderWidth = 100.0F;
@@ -27,10 +37,21 @@ struct Config {
 	float sliderThickMax = 3.2F;
 	float sliderGsPref[4] = {0.3F, 0.59F, 0.11F, 0.0F};
 
+	// The resolution the height field is sliced at for resin printers.
+	float slicePixelSize = 0.05F;
+	float sliceLayerHeight = 0.05F;
+
+	// The region of interest as the left, top, right and bottom edges normalised to the source image.
+	bool roiEnabled = false;
+	float roi[4] = {0.0F, 0.0F, 1.0F, 1.0F};
+
 	const char* dropdownMeshTypes[1] = {"Plane"};
 	int dropdownMesh = 0;
 
 	// Backend
 	bool aboutOpened = false;
 	bool helpOpened = false;
+	bool roiDragging = false;
+	float roiDragStart[2] = {0.0F, 0.0F};
+	std::string exportError;
 };
\ No newline at end of file
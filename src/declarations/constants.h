@@ -4,4 +4,45 @@
 #define DEFAULT_WINDOW_WIDTH 800
 #define DEFAULT_WINDOW_HEIGHT 600
 #define GUI_SIDEPANEL_WIDTH 230
-#define GUI_MENUBAR_HEIGHT 18
\ No newline at end of file
+#define GUI_MENUBAR_HEIGHT 18
+
+// The largest side of the source preview texture, enough for the preview window on high DPI displays.
+#define PREVIEW_TEXTURE_SIZE 512
+
+// The memory decoded images and their depth maps may occupy before the least recently used are evicted (1 GiB).
+#define IMAGE_CACHE_MEMORY_CAP (1024ULL * 1024 * 1024)
+
+// The space compiled meshes and exports may occupy on disk before the least recently used are removed (4 GiB).
+#define MESH_CACHE_DISK_CAP (4ULL * 1024 * 1024 * 1024)
+
+// The version of the meshes CompileModel builds and the files written from them, part of every mesh cache key. Raise it
+// whenever either changes, so meshes and exports cached by a previous version are no longer served.
+#define MESH_CACHE_VERSION 1
+
+// The frames drawn after anything on screen may have changed, enough for the interface to settle after input.
+#define REDRAW_FRAMES 3
+
+// The longest the main loop sleeps waiting for events while idle, in seconds.
+#define IDLE_WAIT_TIMEOUT 1.0
+
+// The time between frames while only a progress bar is changing, in seconds.
+#define PROGRESS_WAIT_TIMEOUT 0.1
+
+// The time each frame may spend uploading a new mesh to the GPU, in milliseconds. Larger meshes arrive over several
+// frames so the window stays responsive.
+#define MESH_UPLOAD_FRAME_BUDGET 4.0
+
+// The size of the pieces a mesh upload is split into, between which the frame budget is checked (8 MiB).
+#define MESH_UPLOAD_CHUNK_SIZE (8ULL * 1024 * 1024)
+
+// The on screen length of the triangle edges the height field preview is tessellated into, in pixels.
+#define HEIGHT_FIELD_SEGMENT_PIXELS 4.0F
+
+// How long after the last rotation or zoom the preview returns to full quality, in seconds.
+#define INTERACTION_SETTLE_TIME 0.25
+
+// The fraction of the viewport resolution the preview is drawn at while the camera moves, before being scaled up.
+#define INTERACTION_RESOLUTION_SCALE 0.5F
+
+// The most triangles drawn while the camera moves, larger meshes are replaced by a simplified proxy until it stops.
+#define PROXY_MESH_TRIANGLES 500000
\ No newline at end of file
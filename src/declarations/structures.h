@@ -1,9 +1,12 @@
 // SPDX-License-Identifier: GPL-3.0
 #pragma once
 
+#include <cstdint>
 #include <glad/gl.h>
 #include <glm/vec3.hpp>
+#include <memory>
 #include <stb_image.h>
+#include <string>
 #include <vector>
 
 struct Image {
@@ -12,7 +15,23 @@ struct Image {
 	int aspectRatioW = 0;
 	int aspectRatioH = 0;
 	stbi_uc* data = nullptr;
-	GLuint texture = 0;
+	std::shared_ptr<stbi_uc> pixels; // Owns data, shared with the image cache.
+	std::string sourceKey; // Identifies the decoded source within the image cache, empty if uncached.
+};
+
+// A window into row pitched RGBA pixels, allowing a sub-rectangle of a buffer to be read in place without copying it.
+struct ImageView {
+	const stbi_uc* data = nullptr; // The first pixel of the underlying buffer, not of the view.
+	int x = 0;
+	int y = 0;
+	int width = 0;
+	int height = 0;
+	size_t rowPitch = 0; // The distance in bytes between the start of consecutive rows in the buffer.
+
+	[[nodiscard]] const stbi_uc* GetPixel(const int column, const int row) const
+	{
+		return data + static_cast<size_t>(y + row) * rowPitch + static_cast<size_t>(x + column) * 4;
+	}
 };
 
 struct Vertex {
@@ -23,8 +42,25 @@ struct Vertex {
 	Vertex(const glm::vec3 position, const glm::vec3 color) : position(position), color(color) {}
 };
 
+// Everything a mesh was compiled from, kept with it so a saved mesh can be reopened as the same job. Fixed size fields
+// only, as it is stored in mesh files as is.
+struct MeshSettings {
+	uint64_t sourceHash = 0; // The hash of the compiled pixels, zero if the mesh has no source.
+	int32_t sourceWidth = 0;
+	int32_t sourceHeight = 0;
+	int32_t meshType = 0;
+	int32_t roiEnabled = 0;
+	float roi[4] = {0.0F, 0.0F, 1.0F, 1.0F};
+	float width = 0.0F;
+	float height = 0.0F;
+	float thickMin = 0.0F;
+	float thickMax = 0.0F;
+	float gsPref[4] = {0.0F, 0.0F, 0.0F, 0.0F};
+};
+
 struct Model {
 	std::vector<Vertex> vertices;
 	std::vector<uint32_t> indices;
 	glm::vec3 centerOffset;
+	MeshSettings settings;
 };
\ No newline at end of file
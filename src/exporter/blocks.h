@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../parallel.h"
+#include "progress.h"
+
+// Append a string without its terminator.
+inline char* AppendText(char* output, const char* text)
+{
+	const size_t length = strlen(text);
+	memcpy(output, text, length);
+
+	return output + length;
+}
+
+// Append a float in its shortest form that still reads back to exactly the same value, at most 15 characters.
+inline char* FormatFloat(char* output, const float value)
+{
+	return std::to_chars(output, output + 16, value).ptr;
+}
+
+// Append an unsigned integer, at most 20 characters.
+inline char* FormatInteger(char* output, const uint64_t value)
+{
+	return std::to_chars(output, output + 20, value).ptr;
+}
+
+// Encode the items [0, count) as variable length output, such as text, in parallel while keeping their order. Items
+// are split into blocks which are encoded by encode(begin, end, buffer) into a buffer per block, a batch of blocks at a
+// time, then handed to write(data, size) in order. Progress advances by the items of every block written. Returns false
+// as soon as a write fails or the export is cancelled.
+template <typename Encode, typename Write>
+bool EncodeBlocks(const size_t count, const size_t blockSize, const Encode& encode, const Write& write,
+                  ExportProgress& progress)
+{
+	const size_t blockCount = (count + blockSize - 1) / blockSize;
+
+	// A few blocks per thread keeps every thread busy without holding much of the output in memory at once.
+	const size_t batchSize = std::max(1U, std::thread::hardware_concurrency()) * 4;
+	std::vector<std::string> buffers(std::min(batchSize, blockCount));
+
+	for (size_t firstBlock = 0; firstBlock < blockCount; firstBlock += batchSize) {
+		const size_t batchBlocks = std::min(batchSize, blockCount - firstBlock);
+
+		ParallelFor(batchBlocks, [&](const size_t begin, const size_t end) {
+			for (size_t block = begin; block < end; block++) {
+				const size_t first = (firstBlock + block) * blockSize;
+
+				buffers[block].clear();
+				encode(first, std::min(first + blockSize, count), buffers[block]);
+			}
+		});
+
+		for (size_t block = 0; block < batchBlocks; block++) {
+			if (progress.IsCancelled() || !write(buffers[block].data(), buffers[block].size())) {
+				return false;
+			}
+
+			const size_t first = (firstBlock + block) * blockSize;
+			progress.Advance(std::min(blockSize, count - first));
+		}
+	}
+
+	return true;
+}
\ No newline at end of file
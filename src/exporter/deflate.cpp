@@ -0,0 +1,593 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "deflate.h"
+#include <algorithm>
+#include <array>
+#include <queue>
+#include <utility>
+#include <vector>
+
+// Matching parameters, favouring speed over the last few percent of compression.
+constexpr int DEFLATE_MIN_MATCH = 3;
+constexpr int DEFLATE_MAX_MATCH = 258;
+constexpr int DEFLATE_MAX_CHAIN = 24;
+constexpr int DEFLATE_HASH_BITS = 15;
+
+// The tokens gathered before a block is emitted with its own Huffman codes.
+constexpr size_t DEFLATE_BLOCK_TOKENS = 1 << 16;
+
+// Alphabet sizes and code length limits fixed by the format.
+constexpr int LITLEN_CODES = 286;
+constexpr int DISTANCE_CODES = 30;
+constexpr int CODELEN_CODES = 19;
+constexpr int MAX_CODE_LENGTH = 15;
+constexpr int MAX_CODELEN_LENGTH = 7;
+
+constexpr uint16_t LENGTH_BASE[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                      31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                      2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr uint16_t DISTANCE_BASE[30] = {1,    2,    3,    4,    5,    7,    9,    13,    17,    25,
+                                        33,   49,   65,   97,   129,  193,  257,  385,   513,   769,
+                                        1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr uint8_t DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+                                        6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+// The order the code length code lengths are written in.
+constexpr uint8_t CODELEN_ORDER[CODELEN_CODES] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+// A literal byte when distance is zero, otherwise a match of length bytes distance bytes back.
+struct Token {
+	uint16_t length;
+	uint16_t distance;
+};
+
+// Writes bits least significant first, as deflate expects.
+class BitWriter {
+public:
+	explicit BitWriter(std::string& output) : m_output(output) {}
+
+	void Write(const uint32_t bits, const int count)
+	{
+		m_buffer |= static_cast<uint64_t>(bits) << m_count;
+		m_count += count;
+
+		while (m_count >= 8) {
+			m_output.push_back(static_cast<char>(m_buffer & 0xFF));
+			m_buffer >>= 8;
+			m_count -= 8;
+		}
+	}
+
+	void AlignToByte()
+	{
+		if (m_count > 0) {
+			Write(0, 8 - m_count);
+		}
+	}
+private:
+	std::string& m_output;
+	uint64_t m_buffer = 0;
+	int m_count = 0;
+};
+
+int GetLengthCode(const int length)
+{
+	int code = 28;
+
+	while (LENGTH_BASE[code] > length) {
+		code--;
+	}
+
+	return code;
+}
+
+int GetDistanceCode(const int distance)
+{
+	int code = 29;
+
+	while (DISTANCE_BASE[code] > distance) {
+		code--;
+	}
+
+	return code;
+}
+
+// Build Huffman code lengths for the frequencies, no longer than maxLength. Rather than a true length limited
+// construction the frequencies are flattened until the tree fits, which rarely triggers and costs little compression.
+void BuildCodeLengths(std::vector<uint32_t> frequencies, const int maxLength, std::vector<uint8_t>& lengths)
+{
+	const size_t symbolCount = frequencies.size();
+	lengths.assign(symbolCount, 0);
+
+	// Guarantee at least two used symbols so every code is complete, which all decoders accept.
+	for (size_t symbol = 0, used = std::ranges::count_if(frequencies, [](const uint32_t f) { return f > 0; });
+	     used < 2 && symbol < symbolCount; symbol++) {
+		if (frequencies[symbol] == 0) {
+			frequencies[symbol] = 1;
+			used++;
+		}
+	}
+
+	while (true) {
+		// Nodes below symbolCount are leaves, the rest are internal nodes.
+		std::vector<int> parent(symbolCount * 2, -1);
+		std::priority_queue<std::pair<uint64_t, int>, std::vector<std::pair<uint64_t, int>>, std::greater<>> queue;
+
+		for (size_t symbol = 0; symbol < symbolCount; symbol++) {
+			if (frequencies[symbol] > 0) {
+				queue.emplace(frequencies[symbol], static_cast<int>(symbol));
+			}
+		}
+
+		int nextNode = static_cast<int>(symbolCount);
+
+		while (queue.size() > 1) {
+			const auto [firstWeight, first] = queue.top();
+			queue.pop();
+			const auto [secondWeight, second] = queue.top();
+			queue.pop();
+
+			parent[first] = nextNode;
+			parent[second] = nextNode;
+			queue.emplace(firstWeight + secondWeight, nextNode++);
+		}
+
+		int longest = 0;
+
+		for (size_t symbol = 0; symbol < symbolCount; symbol++) {
+			if (frequencies[symbol] == 0) {
+				continue;
+			}
+
+			int depth = 0;
+
+			for (int node = static_cast<int>(symbol); parent[node] != -1; node = parent[node]) {
+				depth++;
+			}
+
+			lengths[symbol] = static_cast<uint8_t>(depth);
+			longest = std::max(longest, depth);
+		}
+
+		if (longest <= maxLength) {
+			return;
+		}
+
+		for (uint32_t& frequency : frequencies) {
+			if (frequency > 0) {
+				frequency = (frequency + 1) / 2;
+			}
+		}
+	}
+}
+
+// Assign canonical codes to the lengths, bit reversed so they can be written least significant bit first.
+void BuildCodes(const std::vector<uint8_t>& lengths, std::vector<uint16_t>& codes)
+{
+	std::array<uint16_t, MAX_CODE_LENGTH + 1> lengthCount = {};
+	std::array<uint16_t, MAX_CODE_LENGTH + 1> nextCode = {};
+
+	for (const uint8_t length : lengths) {
+		lengthCount[length]++;
+	}
+
+	lengthCount[0] = 0;
+
+	for (int bits = 1, code = 0; bits <= MAX_CODE_LENGTH; bits++) {
+		code = (code + lengthCount[bits - 1]) << 1;
+		nextCode[bits] = static_cast<uint16_t>(code);
+	}
+
+	codes.assign(lengths.size(), 0);
+
+	for (size_t symbol = 0; symbol < lengths.size(); symbol++) {
+		const int length = lengths[symbol];
+
+		if (length == 0) {
+			continue;
+		}
+
+		uint16_t code = nextCode[length]++;
+		uint16_t reversed = 0;
+
+		for (int bit = 0; bit < length; bit++) {
+			reversed = static_cast<uint16_t>((reversed << 1) | (code & 1));
+			code >>= 1;
+		}
+
+		codes[symbol] = reversed;
+	}
+}
+
+// Run length encode the combined code lengths with the code length alphabet, as symbol and extra bit pairs.
+void EncodeCodeLengths(const std::vector<uint8_t>& lengths, std::vector<std::pair<uint8_t, uint8_t>>& symbols)
+{
+	for (size_t index = 0; index < lengths.size();) {
+		const uint8_t length = lengths[index];
+		size_t run = 1;
+
+		while (index + run < lengths.size() && lengths[index + run] == length) {
+			run++;
+		}
+
+		index += run;
+
+		if (length == 0) {
+			while (run >= 11) {
+				const size_t count = std::min<size_t>(run, 138);
+				symbols.emplace_back(18, static_cast<uint8_t>(count - 11));
+				run -= count;
+			}
+
+			if (run >= 3) {
+				symbols.emplace_back(17, static_cast<uint8_t>(run - 3));
+				run = 0;
+			}
+		} else {
+			symbols.emplace_back(length, 0);
+			run--;
+
+			while (run >= 3) {
+				const size_t count = std::min<size_t>(run, 6);
+				symbols.emplace_back(16, static_cast<uint8_t>(count - 3));
+				run -= count;
+			}
+		}
+
+		for (; run > 0; run--) {
+			symbols.emplace_back(length, 0);
+		}
+	}
+}
+
+// Emit the tokens as one block with its own Huffman codes, or stored if that would be smaller.
+void WriteBlock(BitWriter& writer, const std::vector<Token>& tokens, const unsigned char* raw, const size_t rawSize,
+                const bool final)
+{
+	std::vector<uint32_t> litlenFrequencies(LITLEN_CODES, 0);
+	std::vector<uint32_t> distanceFrequencies(DISTANCE_CODES, 0);
+
+	for (const Token& token : tokens) {
+		if (token.distance == 0) {
+			litlenFrequencies[token.length]++;
+		} else {
+			litlenFrequencies[257 + GetLengthCode(token.length)]++;
+			distanceFrequencies[GetDistanceCode(token.distance)]++;
+		}
+	}
+
+	litlenFrequencies[256] = 1; // The end of block marker.
+
+	std::vector<uint8_t> litlenLengths;
+	std::vector<uint8_t> distanceLengths;
+	BuildCodeLengths(litlenFrequencies, MAX_CODE_LENGTH, litlenLengths);
+	BuildCodeLengths(distanceFrequencies, MAX_CODE_LENGTH, distanceLengths);
+
+	int litlenCount = LITLEN_CODES;
+	int distanceCount = DISTANCE_CODES;
+
+	while (litlenCount > 257 && litlenLengths[litlenCount - 1] == 0) {
+		litlenCount--;
+	}
+
+	while (distanceCount > 1 && distanceLengths[distanceCount - 1] == 0) {
+		distanceCount--;
+	}
+
+	// Both code length tables are compressed together as a single sequence.
+	std::vector<uint8_t> combined(litlenLengths.begin(), litlenLengths.begin() + litlenCount);
+	combined.insert(combined.end(), distanceLengths.begin(), distanceLengths.begin() + distanceCount);
+
+	std::vector<std::pair<uint8_t, uint8_t>> codelenSymbols;
+	EncodeCodeLengths(combined, codelenSymbols);
+
+	std::vector<uint32_t> codelenFrequencies(CODELEN_CODES, 0);
+
+	for (const auto& [symbol, extra] : codelenSymbols) {
+		codelenFrequencies[symbol]++;
+	}
+
+	std::vector<uint8_t> codelenLengths;
+	BuildCodeLengths(codelenFrequencies, MAX_CODELEN_LENGTH, codelenLengths);
+
+	int codelenCount = CODELEN_CODES;
+
+	while (codelenCount > 4 && codelenLengths[CODELEN_ORDER[codelenCount - 1]] == 0) {
+		codelenCount--;
+	}
+
+	// Compare the exact size of the block in both forms.
+	uint64_t dynamicBits = 3 + 5 + 5 + 4 + codelenCount * 3;
+
+	for (const auto& [symbol, extra] : codelenSymbols) {
+		dynamicBits += codelenLengths[symbol] + (symbol == 16 ? 2 : symbol == 17 ? 3 : symbol == 18 ? 7 : 0);
+	}
+
+	for (int symbol = 0; symbol < LITLEN_CODES; symbol++) {
+		dynamicBits += static_cast<uint64_t>(litlenFrequencies[symbol]) *
+		               (litlenLengths[symbol] + (symbol >= 257 ? LENGTH_EXTRA[symbol - 257] : 0));
+	}
+
+	for (int symbol = 0; symbol < DISTANCE_CODES; symbol++) {
+		dynamicBits += static_cast<uint64_t>(distanceFrequencies[symbol]) *
+		               (distanceLengths[symbol] + DISTANCE_EXTRA[symbol]);
+	}
+
+	if (const uint64_t storedBits = 8 * (rawSize + 5 * ((rawSize + 65534) / 65535)) + 8; storedBits < dynamicBits) {
+		for (size_t offset = 0; offset < rawSize; offset += 65535) {
+			const auto length = static_cast<uint16_t>(std::min<size_t>(rawSize - offset, 65535));
+			const bool last = offset + length >= rawSize;
+
+			writer.Write(final && last ? 1 : 0, 1);
+			writer.Write(0, 2);
+			writer.AlignToByte();
+			writer.Write(length, 16);
+			writer.Write(static_cast<uint16_t>(~length), 16);
+
+			for (size_t byte = 0; byte < length; byte++) {
+				writer.Write(raw[offset + byte], 8);
+			}
+		}
+
+		return;
+	}
+
+	std::vector<uint16_t> litlenCodes;
+	std::vector<uint16_t> distanceCodes;
+	std::vector<uint16_t> codelenCodes;
+	BuildCodes(litlenLengths, litlenCodes);
+	BuildCodes(distanceLengths, distanceCodes);
+	BuildCodes(codelenLengths, codelenCodes);
+
+	writer.Write(final ? 1 : 0, 1);
+	writer.Write(2, 2); // Dynamic Huffman codes.
+	writer.Write(litlenCount - 257, 5);
+	writer.Write(distanceCount - 1, 5);
+	writer.Write(codelenCount - 4, 4);
+
+	for (int index = 0; index < codelenCount; index++) {
+		writer.Write(codelenLengths[CODELEN_ORDER[index]], 3);
+	}
+
+	for (const auto& [symbol, extra] : codelenSymbols) {
+		writer.Write(codelenCodes[symbol], codelenLengths[symbol]);
+
+		if (symbol == 16) {
+			writer.Write(extra, 2);
+		} else if (symbol == 17) {
+			writer.Write(extra, 3);
+		} else if (symbol == 18) {
+			writer.Write(extra, 7);
+		}
+	}
+
+	for (const Token& token : tokens) {
+		if (token.distance == 0) {
+			writer.Write(litlenCodes[token.length], litlenLengths[token.length]);
+			continue;
+		}
+
+		const int lengthCode = GetLengthCode(token.length);
+		const int distanceCode = GetDistanceCode(token.distance);
+
+		writer.Write(litlenCodes[257 + lengthCode], litlenLengths[257 + lengthCode]);
+		writer.Write(token.length - LENGTH_BASE[lengthCode], LENGTH_EXTRA[lengthCode]);
+		writer.Write(distanceCodes[distanceCode], distanceLengths[distanceCode]);
+		writer.Write(token.distance - DISTANCE_BASE[distanceCode], DISTANCE_EXTRA[distanceCode]);
+	}
+
+	writer.Write(litlenCodes[256], litlenLengths[256]);
+}
+
+uint32_t HashBytes(const unsigned char* bytes)
+{
+	const uint32_t value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16);
+	return (value * 2654435761U) >> (32 - DEFLATE_HASH_BITS);
+}
+
+void DeflateChunk(const unsigned char* data, const size_t size, size_t historySize, const bool final,
+                  std::string& output)
+{
+	historySize = std::min(historySize, DEFLATE_WINDOW_SIZE);
+
+	// Positions are relative to the start of the history, with -1 marking an empty slot.
+	const unsigned char* window = data - historySize;
+	const size_t windowSize = historySize + size;
+
+	std::vector<int32_t> head(1 << DEFLATE_HASH_BITS, -1);
+	std::vector<int32_t> previous(windowSize, -1);
+
+	const auto insert = [&](const size_t position) {
+		const uint32_t hash = HashBytes(window + position);
+		previous[position] = head[hash];
+		head[hash] = static_cast<int32_t>(position);
+	};
+
+	for (size_t position = 0; position < historySize && position + DEFLATE_MIN_MATCH <= windowSize; position++) {
+		insert(position);
+	}
+
+	BitWriter writer(output);
+
+	std::vector<Token> tokens;
+	tokens.reserve(DEFLATE_BLOCK_TOKENS);
+
+	size_t blockStart = historySize;
+	size_t position = historySize;
+
+	while (position < windowSize) {
+		int bestLength = 0;
+		int bestDistance = 0;
+
+		if (position + DEFLATE_MIN_MATCH <= windowSize) {
+			const int maxLength = static_cast<int>(std::min<size_t>(DEFLATE_MAX_MATCH, windowSize - position));
+			int32_t candidate = head[HashBytes(window + position)];
+
+			for (int chain = 0; chain < DEFLATE_MAX_CHAIN && candidate >= 0; chain++) {
+				const size_t distance = position - candidate;
+
+				if (distance > DEFLATE_WINDOW_SIZE) {
+					break;
+				}
+
+				// Check the byte that would extend the best match first, as most candidates fail there.
+				if (window[candidate + bestLength] == window[position + bestLength]) {
+					int length = 0;
+
+					while (length < maxLength && window[candidate + length] == window[position + length]) {
+						length++;
+					}
+
+					if (length > bestLength) {
+						bestLength = length;
+						bestDistance = static_cast<int>(distance);
+
+						if (length == maxLength) {
+							break;
+						}
+					}
+				}
+
+				candidate = previous[candidate];
+			}
+
+			insert(position);
+		}
+
+		if (bestLength >= DEFLATE_MIN_MATCH) {
+			tokens.push_back({static_cast<uint16_t>(bestLength), static_cast<uint16_t>(bestDistance)});
+
+			for (size_t skipped = position + 1; skipped < position + bestLength; skipped++) {
+				if (skipped + DEFLATE_MIN_MATCH <= windowSize) {
+					insert(skipped);
+				}
+			}
+
+			position += bestLength;
+		} else {
+			tokens.push_back({window[position], 0});
+			position++;
+		}
+
+		// Blocks are cut at a fixed token count so each gets codes suited to its part of the data. The last block is
+		// left for after the loop so it can be marked as final.
+		if (tokens.size() >= DEFLATE_BLOCK_TOKENS && position < windowSize) {
+			WriteBlock(writer, tokens, window + blockStart, position - blockStart, false);
+			tokens.clear();
+			blockStart = position;
+		}
+	}
+
+	if (!tokens.empty()) {
+		WriteBlock(writer, tokens, window + blockStart, position - blockStart, final);
+	} else if (final) {
+		// Nothing is left to encode, so end the stream with an empty fixed Huffman block.
+		writer.Write(1, 1);
+		writer.Write(1, 2);
+		writer.Write(0, 7);
+	}
+
+	if (!final) {
+		// An empty stored block leaves the stream byte aligned so the next chunk can be appended directly.
+		writer.Write(0, 1);
+		writer.Write(0, 2);
+		writer.AlignToByte();
+		writer.Write(0x0000, 16);
+		writer.Write(0xFFFF, 16);
+	}
+
+	writer.AlignToByte();
+}
+
+uint32_t Crc32(uint32_t crc, const unsigned char* data, const size_t size)
+{
+	static const auto table = [] {
+		std::array<uint32_t, 256> values = {};
+
+		for (uint32_t index = 0; index < 256; index++) {
+			uint32_t value = index;
+
+			for (int bit = 0; bit < 8; bit++) {
+				value = (value & 1) != 0 ? 0xEDB88320U ^ (value >> 1) : value >> 1;
+			}
+
+			values[index] = value;
+		}
+
+		return values;
+	}();
+
+	crc = ~crc;
+
+	for (size_t index = 0; index < size; index++) {
+		crc = table[(crc ^ data[index]) & 0xFF] ^ (crc >> 8);
+	}
+
+	return ~crc;
+}
+
+// Multiply a vector by a 32x32 matrix over GF(2).
+uint32_t Gf2MatrixTimes(const uint32_t* matrix, uint32_t vector)
+{
+	uint32_t sum = 0;
+
+	for (; vector != 0; vector >>= 1, matrix++) {
+		if ((vector & 1) != 0) {
+			sum ^= *matrix;
+		}
+	}
+
+	return sum;
+}
+
+void Gf2MatrixSquare(uint32_t* square, const uint32_t* matrix)
+{
+	for (int row = 0; row < 32; row++) {
+		square[row] = Gf2MatrixTimes(matrix, matrix[row]);
+	}
+}
+
+uint32_t Crc32Combine(uint32_t crcFirst, const uint32_t crcSecond, uint64_t sizeSecond)
+{
+	// Appending zeros to the first CRC is a linear operation, applied here by repeated squaring of the operator for a
+	// single zero bit, as zlib does.
+	if (sizeSecond == 0) {
+		return crcFirst;
+	}
+
+	uint32_t even[32];
+	uint32_t odd[32];
+
+	odd[0] = 0xEDB88320U;
+
+	for (uint32_t row = 1, bit = 1; row < 32; row++, bit <<= 1) {
+		odd[row] = bit;
+	}
+
+	Gf2MatrixSquare(even, odd); // Two zero bits.
+	Gf2MatrixSquare(odd, even); // Four zero bits.
+
+	do {
+		Gf2MatrixSquare(even, odd);
+
+		if ((sizeSecond & 1) != 0) {
+			crcFirst = Gf2MatrixTimes(even, crcFirst);
+		}
+
+		sizeSecond >>= 1;
+
+		if (sizeSecond == 0) {
+			break;
+		}
+
+		Gf2MatrixSquare(odd, even);
+
+		if ((sizeSecond & 1) != 0) {
+			crcFirst = Gf2MatrixTimes(odd, crcFirst);
+		}
+
+		sizeSecond >>= 1;
+	} while (sizeSecond != 0);
+
+	return crcFirst ^ crcSecond;
+}
\ No newline at end of file
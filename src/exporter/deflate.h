@@ -0,0 +1,23 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// A self-contained raw deflate (RFC 1951) encoder designed for compressing a stream as independent chunks in parallel.
+// Every chunk may match against up to 32 KiB of the data directly before it, so the chunks concatenate into a single
+// stream that compresses nearly as well as a serial encoder would.
+
+// The size of the window every chunk may reach back into.
+constexpr size_t DEFLATE_WINDOW_SIZE = 32768;
+
+// Compress size bytes at data and append them to output. The historySize bytes before data, at most the window size,
+// must be the preceding bytes of the stream. Unless final is set the output ends byte aligned with an empty stored
+// block, allowing another chunk to follow it directly.
+void DeflateChunk(const unsigned char* data, size_t size, size_t historySize, bool final, std::string& output);
+
+// The CRC-32 of a buffer, as used by zip, continuing from a previous result.
+uint32_t Crc32(uint32_t crc, const unsigned char* data, size_t size);
+// The CRC-32 of two buffers joined together, given the CRC-32 of each and the size of the second.
+uint32_t Crc32Combine(uint32_t crcFirst, uint32_t crcSecond, uint64_t sizeSecond);
\ No newline at end of file
@@ -0,0 +1,212 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "file.h"
+#include <algorithm>
+#include <cerrno>
+#include <string>
+
+#ifdef OS_WINDOWS
+#include <windows.h>
+#else
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+OutputFile::~OutputFile()
+{
+	Close();
+}
+
+#ifdef OS_WINDOWS
+
+// The paths given by the file dialogue are UTF-8, so they must be widened for the Windows API.
+std::wstring WidenPath(const char* filePath)
+{
+	const int wideLength = MultiByteToWideChar(CP_UTF8, 0, filePath, -1, nullptr, 0);
+	std::wstring widePath(wideLength, L'\0');
+	MultiByteToWideChar(CP_UTF8, 0, filePath, -1, widePath.data(), wideLength);
+
+	return widePath;
+}
+
+bool OutputFile::Open(const char* filePath)
+{
+	Close();
+
+	const HANDLE handle = CreateFileW(WidenPath(filePath).c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+	                                  FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (handle == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	m_handle = handle;
+
+	return true;
+}
+
+bool OutputFile::Reserve(const uint64_t size)
+{
+	LARGE_INTEGER position = {};
+	position.QuadPart = static_cast<LONGLONG>(size);
+
+	return SetFilePointerEx(m_handle, position, nullptr, FILE_BEGIN) != 0 && SetEndOfFile(m_handle) != 0;
+}
+
+bool OutputFile::WriteAt(const void* data, size_t size, uint64_t offset)
+{
+	const auto* bytes = static_cast<const unsigned char*>(data);
+
+	while (size > 0) {
+		// An overlapped structure on a synchronous handle gives a positional write.
+		OVERLAPPED overlapped = {};
+		overlapped.Offset = static_cast<DWORD>(offset);
+		overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+		const DWORD chunk = static_cast<DWORD>(std::min<size_t>(size, 1U << 30));
+		DWORD written = 0;
+
+		if (WriteFile(m_handle, bytes, chunk, &written, &overlapped) == 0 || written == 0) {
+			return false;
+		}
+
+		bytes += written;
+		size -= written;
+		offset += written;
+	}
+
+	return true;
+}
+
+bool OutputFile::Close()
+{
+	if (m_handle == nullptr) {
+		return true;
+	}
+
+	const bool flushed = FlushFileBuffers(m_handle) != 0;
+	const bool success = CloseHandle(m_handle) != 0;
+	m_handle = nullptr;
+
+	return flushed && success;
+}
+
+bool OutputFile::IsOpen() const
+{
+	return m_handle != nullptr;
+}
+
+bool RenameFile(const char* fromPath, const char* toPath)
+{
+	// Write through so the rename is on disk by the time it returns, as the data already is.
+	return MoveFileExW(WidenPath(fromPath).c_str(), WidenPath(toPath).c_str(),
+	                   MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+
+bool RemoveFile(const char* filePath)
+{
+	return DeleteFileW(WidenPath(filePath).c_str()) != 0;
+}
+
+#else
+
+bool OutputFile::Open(const char* filePath)
+{
+	Close();
+
+	m_descriptor = open(filePath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+	return m_descriptor >= 0;
+}
+
+bool OutputFile::Reserve(const uint64_t size)
+{
+#ifdef __linux__
+	// Reserve real blocks where the file system supports it, so running out of space fails here and not mid-write.
+	if (posix_fallocate(m_descriptor, 0, static_cast<off_t>(size)) == 0) {
+		return true;
+	}
+#endif
+
+	return ftruncate(m_descriptor, static_cast<off_t>(size)) == 0;
+}
+
+bool OutputFile::WriteAt(const void* data, size_t size, uint64_t offset)
+{
+	const auto* bytes = static_cast<const unsigned char*>(data);
+
+	while (size > 0) {
+		const ssize_t written = pwrite(m_descriptor, bytes, size, static_cast<off_t>(offset));
+
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			return false;
+		}
+
+		bytes += written;
+		size -= written;
+		offset += written;
+	}
+
+	return true;
+}
+
+bool OutputFile::Close()
+{
+	if (m_descriptor < 0) {
+		return true;
+	}
+
+	const bool synced = fsync(m_descriptor) == 0;
+	const bool success = close(m_descriptor) == 0;
+	m_descriptor = -1;
+
+	return synced && success;
+}
+
+bool OutputFile::IsOpen() const
+{
+	return m_descriptor >= 0;
+}
+
+bool RenameFile(const char* fromPath, const char* toPath)
+{
+	// The new file is created with default permissions, replacing a file must not loosen or tighten its own.
+	struct stat existing = {};
+
+	if (stat(toPath, &existing) == 0 && chmod(fromPath, existing.st_mode & 07777) != 0) {
+		return false;
+	}
+
+	if (rename(fromPath, toPath) != 0) {
+		return false;
+	}
+
+	// The new directory entry is only durable once the directory itself has been synced.
+	const std::string path = toPath;
+	const size_t separator = path.rfind('/');
+	const std::string directory = separator == std::string::npos ? "." : path.substr(0, std::max<size_t>(separator, 1));
+
+	const int descriptor = open(directory.c_str(), O_RDONLY);
+
+	if (descriptor < 0) {
+		return false;
+	}
+
+	// Some file systems can not sync a directory at all, which is no failure of this save.
+	const bool synced = fsync(descriptor) == 0 || errno == EINVAL;
+	close(descriptor);
+
+	return synced;
+}
+
+bool RemoveFile(const char* filePath)
+{
+	return unlink(filePath) == 0;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// A file opened for writing at explicit offsets. Writes do not share a file position, so separate threads may write
+// disjoint ranges of the same file at once.
+class OutputFile {
+public:
+	OutputFile() = default;
+	~OutputFile();
+
+	OutputFile(const OutputFile&) = delete;
+	OutputFile& operator=(const OutputFile&) = delete;
+
+	// Create or truncate a file by its UTF-8 path.
+	bool Open(const char* filePath);
+	// Allocate the full size of the file upfront so parallel writes do not fragment it or race to extend it.
+	bool Reserve(uint64_t size);
+	bool WriteAt(const void* data, size_t size, uint64_t offset);
+	// Flush the file to storage and close it, only once this succeeds is the file safely written.
+	bool Close();
+
+	[[nodiscard]] bool IsOpen() const;
+private:
+#ifdef OS_WINDOWS
+	void* m_handle = nullptr;
+#else
+	int m_descriptor = -1;
+#endif
+};
+
+// Atomically replace toPath with the file at fromPath, so toPath is either the old file or the complete new one.
+// An existing toPath keeps its permissions. Returns false if the rename failed or could not be made durable.
+bool RenameFile(const char* fromPath, const char* toPath);
+bool RemoveFile(const char* filePath);
\ No newline at end of file
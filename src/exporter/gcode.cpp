@@ -0,0 +1,766 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "gcode.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <glm/geometric.hpp>
+#include <glm/vec2.hpp>
+#include <iostream>
+#include <iterator>
+#include <numbers>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "../parallel.h"
+#include "mesh.h"
+
+// The layers are sampled this many times per line width, setting how closely the paths follow the edges.
+constexpr float GCODE_SAMPLES_PER_LINE = 4.0F;
+
+// Paths are simplified while they stay within this distance of the traced contour.
+constexpr float GCODE_TOLERANCE = 0.01F;
+
+// Stands in for an unbounded squared distance in the distance transform.
+constexpr float GCODE_FAR = 1e20F;
+
+// Room for a typical number in the G-code, longer ones grow the output until they fit.
+constexpr size_t GCODE_NUMBER_SIZE = 16;
+
+using Path = std::vector<glm::vec2>;
+
+// Every field of a profile with the name it is stored under, so reading and writing share a single list.
+template <typename Profile, typename Visit>
+void VisitProfile(Profile& profile, const Visit& visit)
+{
+	visit("bedWidth", profile.bedWidth);
+	visit("bedDepth", profile.bedDepth);
+	visit("lineWidth", profile.lineWidth);
+	visit("layerHeight", profile.layerHeight);
+	visit("filamentDiameter", profile.filamentDiameter);
+	visit("extrusionMultiplier", profile.extrusionMultiplier);
+	visit("perimeters", profile.perimeters);
+	visit("nozzleTemperature", profile.nozzleTemperature);
+	visit("bedTemperature", profile.bedTemperature);
+	visit("fanSpeed", profile.fanSpeed);
+	visit("printSpeed", profile.printSpeed);
+	visit("firstLayerSpeed", profile.firstLayerSpeed);
+	visit("travelSpeed", profile.travelSpeed);
+	visit("retractLength", profile.retractLength);
+	visit("retractSpeed", profile.retractSpeed);
+	visit("retractMinTravel", profile.retractMinTravel);
+	visit("startGcode", profile.startGcode);
+	visit("endGcode", profile.endGcode);
+}
+
+std::string TrimText(const std::string& text)
+{
+	const size_t first = text.find_first_not_of(" \t\r");
+
+	if (first == std::string::npos) {
+		return {};
+	}
+
+	return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
+
+bool LoadPrinterProfile(const std::filesystem::path& filePath, PrinterProfile& profile, std::string& error)
+{
+	std::ifstream file(filePath);
+
+	if (!file) {
+		return false;
+	}
+
+	std::string line;
+
+	while (error.empty() && std::getline(file, line)) {
+		line = line.substr(0, line.find('#'));
+
+		const size_t separator = line.find('=');
+
+		if (separator == std::string::npos) {
+			continue;
+		}
+
+		const std::string key = TrimText(line.substr(0, separator));
+		const std::string value = TrimText(line.substr(separator + 1));
+		bool known = false;
+
+		VisitProfile(profile, [&](const char* name, auto& field) {
+			if (key != name) {
+				return;
+			}
+
+			known = true;
+
+			if constexpr (std::is_same_v<std::remove_reference_t<decltype(field)>, std::string>) {
+				field.clear();
+
+				for (size_t index = 0; index < value.size(); index++) {
+					if (value[index] == '\\' && index + 1 < value.size() && value[index + 1] == 'n') {
+						field += '\n';
+						index++;
+					} else {
+						field += value[index];
+					}
+				}
+			} else {
+				const char* end = value.data() + value.size();
+				const auto [parsed, result] = std::from_chars(value.data(), end, field);
+
+				if (result != std::errc() || parsed != end) {
+					error = "The printer profile setting \"" + key + "\" has the invalid value \"" + value + "\".";
+				}
+			}
+		});
+
+		if (!known) {
+			std::cout << "Unknown printer profile setting \"" << key << "\".\n";
+		}
+	}
+
+	return error.empty();
+}
+
+bool ValidatePrinterProfile(const PrinterProfile& profile, std::string& error)
+{
+	const auto isPositive = [](const float value) { return std::isfinite(value) && value > 0.0F; };
+	const auto isNonNegative = [](const float value) { return std::isfinite(value) && value >= 0.0F; };
+
+	if (!isPositive(profile.bedWidth) || !isPositive(profile.bedDepth)) {
+		error = "The printer profile needs a positive bed width and depth.";
+	} else if (!isPositive(profile.lineWidth) || !isPositive(profile.layerHeight) ||
+	           !isPositive(profile.filamentDiameter) || !isPositive(profile.extrusionMultiplier)) {
+		error = "The printer profile needs a positive line width, layer height, filament diameter and extrusion "
+		        "multiplier.";
+	} else if (!isPositive(profile.printSpeed) || !isPositive(profile.firstLayerSpeed) ||
+	           !isPositive(profile.travelSpeed) || !isPositive(profile.retractSpeed)) {
+		error = "The printer profile needs positive print, first layer, travel and retract speeds.";
+	} else if (!isNonNegative(profile.retractLength) || !isNonNegative(profile.retractMinTravel)) {
+		error = "The printer profile needs a retract length and minimum travel of zero or more.";
+	} else if (profile.perimeters < 0 || profile.nozzleTemperature < 0 || profile.bedTemperature < 0) {
+		error = "The printer profile needs perimeters and temperatures of zero or more.";
+	}
+
+	return error.empty();
+}
+
+// Append a float with a fixed number of decimals.
+void AppendFixed(std::string& output, const float value, const int precision)
+{
+	const size_t start = output.size();
+	size_t capacity = GCODE_NUMBER_SIZE;
+
+	// Running out of room is the only way the conversion fails.
+	while (true) {
+		output.resize(start + capacity);
+
+		const auto [end, result] = std::to_chars(output.data() + start, output.data() + output.size(), value,
+		                                         std::chars_format::fixed, precision);
+
+		if (result == std::errc()) {
+			output.resize(end - output.data());
+			return;
+		}
+
+		capacity *= 2;
+	}
+}
+
+bool SavePrinterProfile(const std::filesystem::path& filePath, const PrinterProfile& profile)
+{
+	std::ofstream file(filePath, std::ios::trunc);
+
+	file << "# LithoGen printer profile, lengths in mm, speeds in mm/s and temperatures in degrees Celsius.\n";
+
+	VisitProfile(profile, [&file](const char* name, const auto& field) {
+		file << name << " = ";
+
+		if constexpr (std::is_same_v<std::remove_cvref_t<decltype(field)>, std::string>) {
+			for (const char character : field) {
+				if (character == '\n') {
+					file << "\\n";
+				} else {
+					file << character;
+				}
+			}
+		} else {
+			file << field;
+		}
+
+		file << '\n';
+	});
+
+	return static_cast<bool>(file);
+}
+
+// The thickness of the model sampled at the centres of a regular grid of squares, surrounded by a border of empty
+// samples so every contour traced from it is closed. The edge of the model falls half way between the outermost
+// samples and the border, which is where the distance field places it.
+struct ThicknessGrid {
+	int width = 0;
+	int height = 0;
+	float spacing = 0.0F;
+	float modelWidth = 0.0F;
+	float modelHeight = 0.0F;
+	std::vector<float> samples;
+};
+
+bool BuildThicknessGrid(const Model& model, const float spacing, ThicknessGrid& grid)
+{
+	const MeshSettings& settings = model.settings;
+	const int columns = settings.sourceWidth;
+	const int rows = settings.sourceHeight;
+
+	// Only a compiled model holds its front surface as a grid of pixel corner vertices, at the start of its vertices.
+	if (columns <= 0 || rows <= 0 || model.vertices.size() < static_cast<size_t>(columns + 1) * (rows + 1)) {
+		return false;
+	}
+
+	const float pixelSize = settings.width / static_cast<float>(columns);
+
+	grid.spacing = spacing;
+	grid.modelWidth = pixelSize * static_cast<float>(columns);
+	grid.modelHeight = pixelSize * static_cast<float>(rows);
+	grid.width = std::max(1, static_cast<int>(std::round(grid.modelWidth / spacing))) + 2;
+	grid.height = std::max(1, static_cast<int>(std::round(grid.modelHeight / spacing))) + 2;
+	grid.samples.assign(static_cast<size_t>(grid.width) * grid.height, -1.0F);
+
+	// The back of the model sits at the minimum thickness, the front surface comes forward from zero.
+	const auto getThickness = [&](const int column, const int row) {
+		return settings.thickMin - model.vertices[static_cast<size_t>(row) * (columns + 1) + column].position.z;
+	};
+
+	ParallelFor(
+		static_cast<size_t>(grid.height - 2),
+		[&](const size_t begin, const size_t end) {
+			for (size_t y = begin; y < end; y++) {
+				const float v =
+					std::min((static_cast<float>(y) + 0.5F) * spacing / pixelSize, static_cast<float>(rows));
+				const int row = std::min(static_cast<int>(v), rows - 1);
+				const float fractionY = v - static_cast<float>(row);
+				float* output = grid.samples.data() + (y + 1) * grid.width + 1;
+
+				for (int x = 0; x < grid.width - 2; x++) {
+					const float u =
+						std::min((static_cast<float>(x) + 0.5F) * spacing / pixelSize, static_cast<float>(columns));
+					const int column = std::min(static_cast<int>(u), columns - 1);
+					const float fractionX = u - static_cast<float>(column);
+
+					const float upper = std::lerp(getThickness(column, row), getThickness(column + 1, row), fractionX);
+					const float lower =
+						std::lerp(getThickness(column, row + 1), getThickness(column + 1, row + 1), fractionX);
+
+					output[x] = std::lerp(upper, lower, fractionY);
+				}
+			}
+		},
+		16);
+
+	return true;
+}
+
+// The working memory of the distance transform along one line of samples.
+struct DistanceScratch {
+	std::vector<float> values;
+	std::vector<float> bounds;
+	std::vector<int> parabolas;
+};
+
+// The exact squared distance transform of one line of samples (Felzenszwalb and Huttenlocher), in place.
+void TransformLine(float* line, const size_t count, const size_t stride, DistanceScratch& scratch)
+{
+	scratch.values.resize(count);
+	scratch.bounds.resize(count + 1);
+	scratch.parabolas.resize(count);
+
+	for (size_t index = 0; index < count; index++) {
+		scratch.values[index] = line[index * stride];
+	}
+
+	const std::vector<float>& f = scratch.values;
+	std::vector<float>& bounds = scratch.bounds;
+	std::vector<int>& parabolas = scratch.parabolas;
+
+	// Find the lower envelope of the parabolas rooted at every sample.
+	size_t last = 0;
+	parabolas[0] = 0;
+	bounds[0] = -GCODE_FAR;
+	bounds[1] = GCODE_FAR;
+
+	for (int q = 1; q < static_cast<int>(count); q++) {
+		float intersection = 0.0F;
+
+		while (true) {
+			const int p = parabolas[last];
+			intersection = (f[q] + static_cast<float>(q * q) - (f[p] + static_cast<float>(p * p))) /
+			               static_cast<float>(2 * (q - p));
+
+			if (intersection > bounds[last] || last == 0) {
+				break;
+			}
+
+			last--;
+		}
+
+		if (intersection <= bounds[last]) {
+			parabolas[0] = q;
+			bounds[1] = GCODE_FAR;
+			continue;
+		}
+
+		last++;
+		parabolas[last] = q;
+		bounds[last] = intersection;
+		bounds[last + 1] = GCODE_FAR;
+	}
+
+	size_t parabola = 0;
+
+	for (int q = 0; q < static_cast<int>(count); q++) {
+		while (bounds[parabola + 1] < static_cast<float>(q)) {
+			parabola++;
+		}
+
+		const int p = parabolas[parabola];
+		line[q * stride] = static_cast<float>((q - p) * (q - p)) + f[p];
+	}
+}
+
+// The distance in millimetres from every sample inside the layer at the height to the nearest sample outside it,
+// measured to the edge half way between them. Samples outside the layer are given a negative distance.
+void ComputeDistanceField(const ThicknessGrid& grid, const float height, std::vector<float>& field,
+                          DistanceScratch& scratch)
+{
+	field.resize(grid.samples.size());
+
+	for (size_t sample = 0; sample < field.size(); sample++) {
+		field[sample] = grid.samples[sample] >= height ? GCODE_FAR : 0.0F;
+	}
+
+	for (int x = 0; x < grid.width; x++) {
+		TransformLine(field.data() + x, grid.height, grid.width, scratch);
+	}
+
+	for (int y = 0; y < grid.height; y++) {
+		TransformLine(field.data() + static_cast<size_t>(y) * grid.width, grid.width, 1, scratch);
+	}
+
+	for (float& distance : field) {
+		distance = distance > 0.0F ? (std::sqrt(distance) - 0.5F) * grid.spacing : -grid.spacing;
+	}
+}
+
+// The point where a contour at the level crosses an edge between two samples, in samples. Even edges run to the next
+// sample along the row and odd edges to the next sample down the column.
+glm::vec2 GetCrossing(const std::vector<float>& field, const int width, const float level, const int32_t edge)
+{
+	const int32_t sample = edge >> 1;
+	const int32_t next = (edge & 1) == 0 ? sample + 1 : sample + width;
+	const float t = (level - field[sample]) / (field[next] - field[sample]);
+	const auto position = glm::vec2(static_cast<float>(sample % width), static_cast<float>(sample / width));
+
+	return (edge & 1) == 0 ? position + glm::vec2(t, 0.0F) : position + glm::vec2(0.0F, t);
+}
+
+// Remove points that lie within the tolerance of the line between their neighbours (Ramer-Douglas-Peucker).
+void SimplifyPath(Path& path, const size_t first, const size_t last, std::vector<bool>& keep)
+{
+	if (last <= first + 1) {
+		return;
+	}
+
+	const glm::vec2 start = path[first];
+	const glm::vec2 direction = path[last] - start;
+	const float length = glm::length(direction);
+	float farthest = 0.0F;
+	size_t split = first;
+
+	for (size_t index = first + 1; index < last; index++) {
+		const glm::vec2 offset = path[index] - start;
+		const float distance = length > 0.0F ? std::abs(direction.x * offset.y - direction.y * offset.x) / length
+		                                     : glm::length(offset);
+
+		if (distance > farthest) {
+			farthest = distance;
+			split = index;
+		}
+	}
+
+	if (farthest <= GCODE_TOLERANCE) {
+		return;
+	}
+
+	keep[split] = true;
+	SimplifyPath(path, first, split, keep);
+	SimplifyPath(path, split, last, keep);
+}
+
+// Trace the closed contours of the field at a level with marching squares, converted to millimetres in the bed space
+// by toBed. Segments are directed from where they enter the region to where they leave each cell, so every crossing
+// starts exactly one segment and the segments link into loops.
+template <typename ToBed>
+void TraceContours(const std::vector<float>& field, const int width, const int height, const float level,
+                   const float minimumLength, const ToBed& toBed, std::vector<int32_t>& links, std::vector<Path>& paths)
+{
+	links.assign(field.size() * 2, -1);
+
+	for (int y = 0; y < height - 1; y++) {
+		for (int x = 0; x < width - 1; x++) {
+			const int32_t sample = y * width + x;
+
+			// The corners and edges of the cell in order around it.
+			const float values[4] = {
+				field[sample], field[sample + 1], field[sample + width + 1], field[sample + width]};
+			const int32_t edges[4] = {sample * 2, (sample + 1) * 2 + 1, (sample + width) * 2, sample * 2 + 1};
+
+			int inside = 0;
+
+			for (int corner = 0; corner < 4; corner++) {
+				inside |= (values[corner] >= level ? 1 : 0) << corner;
+			}
+
+			if (inside == 0 || inside == 15) {
+				continue;
+			}
+
+			// Opposite corners inside are joined through the centre if it is inside too.
+			const bool saddle = inside == 5 || inside == 10;
+			const bool centreInside = (values[0] + values[1] + values[2] + values[3]) / 4.0F >= level;
+
+			for (int edge = 0; edge < 4; edge++) {
+				const bool fromInside = ((inside >> edge) & 1) != 0;
+				const bool toInside = ((inside >> ((edge + 1) % 4)) & 1) != 0;
+
+				// Each segment is recorded from the edge where it leaves the region.
+				if (!fromInside || toInside) {
+					continue;
+				}
+
+				int entry = 0;
+
+				if (!saddle) {
+					for (entry = 0; entry < 4; entry++) {
+						if (((inside >> entry) & 1) == 0 && ((inside >> ((entry + 1) % 4)) & 1) != 0) {
+							break;
+						}
+					}
+				} else {
+					entry = centreInside ? (edge + 1) % 4 : (edge + 3) % 4;
+				}
+
+				links[edges[entry]] = edges[edge];
+			}
+		}
+	}
+
+	std::vector<bool> keep;
+
+	for (int32_t start = 0; start < static_cast<int32_t>(links.size()); start++) {
+		if (links[start] < 0) {
+			continue;
+		}
+
+		Path path;
+		float length = 0.0F;
+
+		for (int32_t edge = start; links[edge] >= 0;) {
+			path.push_back(toBed(GetCrossing(field, width, level, edge)));
+
+			if (path.size() > 1) {
+				length += glm::distance(path[path.size() - 2], path.back());
+			}
+
+			edge = std::exchange(links[edge], -1);
+		}
+
+		// Specks smaller than a line can not be printed.
+		if (length < minimumLength) {
+			continue;
+		}
+
+		path.push_back(path.front());
+		keep.assign(path.size(), false);
+		keep.front() = true;
+		keep.back() = true;
+		SimplifyPath(path, 0, path.size() - 1, keep);
+
+		Path simplified;
+
+		for (size_t index = 0; index < path.size(); index++) {
+			if (keep[index]) {
+				simplified.push_back(path[index]);
+			}
+		}
+
+		paths.push_back(std::move(simplified));
+	}
+}
+
+// Find the spans of evenly spaced lines across the field where it reaches the level, alternating the direction of
+// every other line so the nozzle snakes across the layer. Vertical lines are traced when transposed is set.
+template <typename ToBed>
+void TraceInfill(const std::vector<float>& field, const ThicknessGrid& grid, const float level, const float spacing,
+                 const bool transposed, const ToBed& toBed, std::vector<Path>& paths)
+{
+	const int along = transposed ? grid.height : grid.width;
+	const int across = transposed ? grid.width : grid.height;
+
+	const auto getValue = [&](const int position, const int line) {
+		return transposed ? field[static_cast<size_t>(position) * grid.width + line]
+		                  : field[static_cast<size_t>(line) * grid.width + position];
+	};
+
+	const auto toPoint = [&](const float position, const float line) {
+		return toBed(transposed ? glm::vec2(line, position) : glm::vec2(position, line));
+	};
+
+	const float extent = transposed ? grid.modelWidth : grid.modelHeight;
+	const int lineCount = static_cast<int>(extent / spacing);
+
+	for (int line = 0; line < lineCount; line++) {
+		// Lines lie between samples, skipping the border, and are read by interpolating the rows either side.
+		const float offset = (static_cast<float>(line) + 0.5F) * spacing / grid.spacing + 0.5F;
+		const int lower = std::min(static_cast<int>(offset), across - 2);
+		const float fraction = offset - static_cast<float>(lower);
+
+		std::vector<Path> spans;
+		float previous = -GCODE_FAR;
+		float spanStart = 0.0F;
+
+		for (int position = 0; position < along; position++) {
+			const float value = std::lerp(getValue(position, lower), getValue(position, lower + 1), fraction);
+
+			if ((value >= level) != (previous >= level) && position > 0) {
+				const float crossing = static_cast<float>(position - 1) + (level - previous) / (value - previous);
+
+				if (value >= level) {
+					spanStart = crossing;
+				} else if (crossing - spanStart > 0.5F) {
+					spans.push_back({toPoint(spanStart, offset), toPoint(crossing, offset)});
+				}
+			}
+
+			previous = value;
+		}
+
+		if (line % 2 == 1) {
+			std::ranges::reverse(spans);
+
+			for (Path& span : spans) {
+				std::ranges::reverse(span);
+			}
+		}
+
+		std::ranges::move(spans, std::back_inserter(paths));
+	}
+}
+
+// Formats the moves of a layer, keeping track of the nozzle between them.
+class GcodeBuilder {
+public:
+	GcodeBuilder(const PrinterProfile& profile, const float speed, std::string& output)
+		: m_profile(profile), m_output(output), m_printFeed(speed * 60.0F)
+	{
+		const float filamentArea =
+			std::numbers::pi_v<float> * profile.filamentDiameter * profile.filamentDiameter / 4.0F;
+
+		m_extrusion = profile.lineWidth * profile.layerHeight / filamentArea * profile.extrusionMultiplier;
+	}
+
+	// Travel to the start of the path, then extrude along it.
+	void Print(const Path& path)
+	{
+		if (path.size() < 2) {
+			return;
+		}
+
+		Travel(path.front());
+
+		if (m_retracted) {
+			Line("G1", nullptr, nullptr, m_profile.retractLength, m_profile.retractSpeed * 60.0F);
+			m_retracted = false;
+		}
+
+		for (size_t index = 1; index < path.size(); index++) {
+			const float length = glm::distance(m_position, path[index]);
+			const bool first = index == 1;
+
+			Line("G1", &path[index].x, &path[index].y, length * m_extrusion, first ? m_printFeed : 0.0F);
+			m_position = path[index];
+		}
+	}
+
+	void Retract()
+	{
+		if (!m_retracted) {
+			Line("G1", nullptr, nullptr, -m_profile.retractLength, m_profile.retractSpeed * 60.0F);
+			m_retracted = true;
+		}
+	}
+private:
+	void Travel(const glm::vec2 target)
+	{
+		// The first travel of a layer has no known start, every layer begins retracted so it is always safe.
+		if (m_hasPosition && glm::distance(m_position, target) >= m_profile.retractMinTravel) {
+			Retract();
+		}
+
+		Line("G0", &target.x, &target.y, 0.0F, m_profile.travelSpeed * 60.0F);
+
+		m_position = target;
+		m_hasPosition = true;
+	}
+
+	// Append a move, only writing the axes given. A feed rate of zero keeps the current one.
+	void Line(const char* command, const float* x, const float* y, const float extrusion, const float feed)
+	{
+		m_output += command;
+
+		if (x != nullptr) {
+			m_output += " X";
+			AppendFixed(m_output, *x, 3);
+			m_output += " Y";
+			AppendFixed(m_output, *y, 3);
+		}
+
+		if (extrusion != 0.0F) {
+			m_output += " E";
+			AppendFixed(m_output, extrusion, 5);
+		}
+
+		if (feed > 0.0F) {
+			m_output += " F";
+			AppendFixed(m_output, feed, 0);
+		}
+
+		m_output += '\n';
+	}
+
+	const PrinterProfile& m_profile;
+	std::string& m_output;
+	float m_printFeed = 0.0F;
+	float m_extrusion = 0.0F;
+
+	glm::vec2 m_position = glm::vec2(0.0F);
+	bool m_hasPosition = false;
+	bool m_retracted = true;
+};
+
+// Slice a single layer into G-code. Layers are independent, every one starts and ends with the filament retracted.
+void EncodeLayer(const ThicknessGrid& grid, const PrinterProfile& profile, const int layer, std::string& buffer)
+{
+	const float height = (static_cast<float>(layer) + 0.5F) * profile.layerHeight;
+
+	std::vector<float> field;
+	DistanceScratch scratch;
+	ComputeDistanceField(grid, height, field, scratch);
+
+	// The image is turned over with its back on the bed, so it reads the right way round from above.
+	const auto toBed = [&grid, &profile](const glm::vec2 sample) {
+		const glm::vec2 position = (sample - 0.5F) * grid.spacing;
+
+		return glm::vec2(profile.bedWidth / 2.0F + position.x - grid.modelWidth / 2.0F,
+		                 profile.bedDepth / 2.0F - position.y + grid.modelHeight / 2.0F);
+	};
+
+	std::vector<int32_t> links;
+	std::vector<Path> perimeters;
+
+	// The outermost perimeter is printed last so it is laid against the ones inside it.
+	for (int perimeter = profile.perimeters - 1; perimeter >= 0; perimeter--) {
+		const float level = (static_cast<float>(perimeter) + 0.5F) * profile.lineWidth;
+		TraceContours(field, grid.width, grid.height, level, profile.lineWidth, toBed, links, perimeters);
+	}
+
+	std::vector<Path> infill;
+	const float infillLevel = std::max(0.5F, static_cast<float>(profile.perimeters)) * profile.lineWidth;
+	TraceInfill(field, grid, infillLevel, profile.lineWidth, layer % 2 == 1, toBed, infill);
+
+	buffer += ";LAYER:" + std::to_string(layer) + "\nG0 Z";
+	AppendFixed(buffer, static_cast<float>(layer + 1) * profile.layerHeight, 3);
+	buffer += '\n';
+
+	if (layer == 1 && profile.fanSpeed > 0) {
+		buffer += "M106 S" + std::to_string(std::min(profile.fanSpeed, 255)) + '\n';
+	}
+
+	GcodeBuilder builder(profile, layer == 0 ? profile.firstLayerSpeed : profile.printSpeed, buffer);
+
+	for (const Path& path : perimeters) {
+		builder.Print(path);
+	}
+
+	for (const Path& path : infill) {
+		builder.Print(path);
+	}
+
+	builder.Retract();
+}
+
+bool WriteGcode(const char* filePath, const Model& model, const PrinterProfile& profile, ExportProgress& progress,
+                std::string& error)
+{
+	if (!ValidatePrinterProfile(profile, error)) {
+		return false;
+	}
+
+	ThicknessGrid grid;
+
+	if (!BuildThicknessGrid(model, profile.lineWidth / GCODE_SAMPLES_PER_LINE, grid)) {
+		error = "Only meshes compiled from an image can be sliced.";
+		return false;
+	}
+
+	const auto format = [](const float value) {
+		char text[16];
+		return std::string(text, FormatFloat(text, value));
+	};
+
+	// The model is centred on the bed, so one larger than the bed would have moves beyond its edges.
+	if (grid.modelWidth > profile.bedWidth || grid.modelHeight > profile.bedDepth) {
+		error = "The model is " + format(grid.modelWidth) + " x " + format(grid.modelHeight) +
+		        " mm, larger than the " + format(profile.bedWidth) + " x " + format(profile.bedDepth) +
+		        " mm bed of the printer profile.";
+		return false;
+	}
+
+	// A layer is printed wherever the model reaches the middle of it.
+	const auto layerCount =
+		static_cast<size_t>(std::max(1.0F, std::ceil(model.settings.thickMax / profile.layerHeight - 0.5F)));
+
+	progress.SetTotal(layerCount);
+	MeshWriter writer(progress);
+
+	if (!writer.Open(filePath)) {
+		return false;
+	}
+
+	std::string retract = "G1 E-";
+	AppendFixed(retract, profile.retractLength, 5);
+	retract += " F";
+	AppendFixed(retract, profile.retractSpeed * 60.0F, 0);
+
+	// Heat the bed and nozzle while the start G-code runs, then leave the filament retracted like every layer ends.
+	const std::string start = "; Generated by LithoGen\n; Layer height: " + format(profile.layerHeight) +
+	                          " mm, line width: " + format(profile.lineWidth) +
+	                          " mm, layers: " + std::to_string(layerCount) +
+	                          "\nG21\nG90\nM83\nM140 S" + std::to_string(profile.bedTemperature) +
+	                          "\nM104 S" + std::to_string(profile.nozzleTemperature) + '\n' + profile.startGcode +
+	                          "\nM190 S" + std::to_string(profile.bedTemperature) +
+	                          "\nM109 S" + std::to_string(profile.nozzleTemperature) +
+	                          '\n' + retract + '\n';
+
+	const auto encodeLayers = [&grid, &profile](const size_t begin, const size_t end, std::string& buffer) {
+		for (size_t layer = begin; layer < end; layer++) {
+			EncodeLayer(grid, profile, static_cast<int>(layer), buffer);
+		}
+	};
+
+	const bool success = writer.Write(start) && writer.WriteText(layerCount, 1, encodeLayers) &&
+	                     writer.Write(profile.endGcode + '\n');
+
+	return writer.Close() && success;
+}
\ No newline at end of file
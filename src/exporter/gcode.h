@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include "../declarations/structures.h"
+#include "progress.h"
+
+// The printer and material a lithophane is sliced for. Lengths are in millimetres, speeds in millimetres per second
+// and temperatures in degrees Celsius.
+struct PrinterProfile {
+	float bedWidth = 220.0F;
+	float bedDepth = 220.0F;
+	float lineWidth = 0.45F;
+	float layerHeight = 0.12F;
+	float filamentDiameter = 1.75F;
+	float extrusionMultiplier = 1.0F;
+	int perimeters = 2;
+	int nozzleTemperature = 210;
+	int bedTemperature = 60;
+	int fanSpeed = 255; // From 0 to 255, the fan is turned on from the second layer.
+	float printSpeed = 40.0F;
+	float firstLayerSpeed = 20.0F;
+	float travelSpeed = 150.0F;
+	float retractLength = 0.8F;
+	float retractSpeed = 35.0F;
+	float retractMinTravel = 1.5F; // Shorter travel moves are made without retracting.
+	std::string startGcode = "G28";
+	std::string endGcode = "M104 S0\nM140 S0\nM107\nG91\nG1 Z10 F600\nG90\nM84";
+};
+
+// Read a profile from a file of "key = value" lines, where # starts a comment and \n in a value is a line break. Keys
+// missing from the file keep their current value. Fails without an error if the file can not be opened, and with one
+// if a number in it can not be read.
+bool LoadPrinterProfile(const std::filesystem::path& filePath, PrinterProfile& profile, std::string& error);
+// Check every length and speed of a profile is finite and in range, describing the first that is not in the error.
+bool ValidatePrinterProfile(const PrinterProfile& profile, std::string& error);
+// Write every field of a profile in the format LoadPrinterProfile reads.
+bool SavePrinterProfile(const std::filesystem::path& filePath, const PrinterProfile& profile);
+
+// Slice the height field of a compiled model into G-code for the printer, without going through a mesh slicer. Each
+// layer is the region where the model is thicker than the middle of the layer, traced with marching squares. It is
+// printed as perimeters along contours of its distance to the edge, then filled solid with lines that alternate
+// direction every layer. Layers are sliced in parallel. The model is placed in the centre of the bed with its flat back
+// down, which is the exported mesh turned over. An invalid profile or a model that can not be printed fails with the
+// reason in the error.
+bool WriteGcode(const char* filePath, const Model& model, const PrinterProfile& profile, ExportProgress& progress,
+                std::string& error);
\ No newline at end of file
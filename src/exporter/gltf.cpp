@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "gltf.h"
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <glm/common.hpp>
+#include "mesh.h"
+
+constexpr uint32_t GLB_MAGIC = 0x46546C67;
+constexpr uint32_t GLB_VERSION = 2;
+constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942;
+
+// The glTF buffer views hold the vertex array as is, interleaving the position and color of every vertex.
+static_assert(std::endian::native == std::endian::little);
+static_assert(sizeof(Vertex) == 6 * sizeof(float) && offsetof(Vertex, color) == 3 * sizeof(float));
+
+std::string FormatJsonVector(const glm::vec3& vector)
+{
+	char buffer[64];
+	char* output = buffer;
+
+	*output++ = '[';
+	output = FormatFloat(output, vector.x);
+	*output++ = ',';
+	output = FormatFloat(output, vector.y);
+	*output++ = ',';
+	output = FormatFloat(output, vector.z);
+	*output++ = ']';
+
+	return {buffer, output};
+}
+
+// The position accessor must state the bounds of the mesh.
+void GetBounds(const Model& model, glm::vec3& minimum, glm::vec3& maximum)
+{
+	minimum = glm::vec3(std::numeric_limits<float>::max());
+	maximum = glm::vec3(std::numeric_limits<float>::lowest());
+
+	std::mutex mutex;
+
+	ParallelFor(
+		model.vertices.size(),
+		[&](const size_t begin, const size_t end) {
+			glm::vec3 blockMinimum = model.vertices[begin].position;
+			glm::vec3 blockMaximum = blockMinimum;
+
+			for (size_t vertex = begin + 1; vertex < end; vertex++) {
+				blockMinimum = glm::min(blockMinimum, model.vertices[vertex].position);
+				blockMaximum = glm::max(blockMaximum, model.vertices[vertex].position);
+			}
+
+			const std::lock_guard lock(mutex);
+			minimum = glm::min(minimum, blockMinimum);
+			maximum = glm::max(maximum, blockMaximum);
+		},
+		65536);
+}
+
+std::string GetGltfJson(const Model& model, const uint64_t vertexSize, const uint64_t indexSize)
+{
+	glm::vec3 minimum;
+	glm::vec3 maximum;
+	GetBounds(model, minimum, maximum);
+
+	const std::string vertexCount = std::to_string(model.vertices.size());
+
+	// The model is measured in millimetres where glTF uses metres, which the node scales by. Normals are left out, as
+	// viewers then compute flat normals themselves, which is what the faceted mesh wants.
+	return R"({"asset":{"version":"2.0","generator":"LithoGen"},"scene":0,"scenes":[{"nodes":[0]}],)"
+	       R"("nodes":[{"mesh":0,"scale":[0.001,0.001,0.001]}],)"
+	       R"("meshes":[{"name":"lithophane","primitives":[{"attributes":{"POSITION":0,"COLOR_0":1},"indices":2}]}],)"
+	       R"("buffers":[{"byteLength":)" + std::to_string(vertexSize + indexSize) + "}],"
+	       R"("bufferViews":[{"buffer":0,"byteLength":)" + std::to_string(vertexSize) +
+	       R"(,"byteStride":24,"target":34962},{"buffer":0,"byteOffset":)" + std::to_string(vertexSize) +
+	       R"(,"byteLength":)" + std::to_string(indexSize) + R"(,"target":34963}],)"
+	       R"("accessors":[{"bufferView":0,"componentType":5126,"count":)" + vertexCount +
+	       R"(,"type":"VEC3","min":)" + FormatJsonVector(minimum) + R"(,"max":)" + FormatJsonVector(maximum) + "},"
+	       R"({"bufferView":0,"byteOffset":12,"componentType":5126,"count":)" + vertexCount + R"(,"type":"VEC3"},)"
+	       R"({"bufferView":1,"componentType":5125,"count":)" + std::to_string(model.indices.size()) +
+	       R"(,"type":"SCALAR"}]})";
+}
+
+void PutChunkHeader(unsigned char* output, const uint32_t length, const uint32_t type)
+{
+	memcpy(output, &length, sizeof(uint32_t));
+	memcpy(output + 4, &type, sizeof(uint32_t));
+}
+
+bool WriteGlb(const char* filePath, const Model& model, ExportProgress& progress)
+{
+	if (model.vertices.empty()) {
+		return false;
+	}
+
+	const uint64_t vertexSize = model.vertices.size() * sizeof(Vertex);
+	const uint64_t indexSize = model.indices.size() * sizeof(uint32_t);
+
+	// Chunks are aligned to four bytes, the JSON is padded with spaces to reach it.
+	std::string json = GetGltfJson(model, vertexSize, indexSize);
+	json.resize((json.size() + 3) & ~size_t{3}, ' ');
+
+	const uint64_t totalSize = 12 + 8 + json.size() + 8 + vertexSize + indexSize;
+
+	// Every length in the container is 32-bit.
+	if (totalSize > std::numeric_limits<uint32_t>::max()) {
+		return false;
+	}
+
+	unsigned char header[20];
+	const auto totalSize32 = static_cast<uint32_t>(totalSize);
+	memcpy(header, &GLB_MAGIC, sizeof(uint32_t));
+	memcpy(header + 4, &GLB_VERSION, sizeof(uint32_t));
+	memcpy(header + 8, &totalSize32, sizeof(uint32_t));
+	PutChunkHeader(header + 12, static_cast<uint32_t>(json.size()), GLB_CHUNK_JSON);
+
+	unsigned char binaryHeader[8];
+	PutChunkHeader(binaryHeader, static_cast<uint32_t>(vertexSize + indexSize), GLB_CHUNK_BIN);
+
+	progress.SetTotal(model.vertices.size() + model.indices.size() / 3);
+	MeshWriter writer(progress);
+
+	if (!writer.Open(filePath, totalSize)) {
+		return false;
+	}
+
+	const bool success = writer.Write(header, sizeof(header)) && writer.Write(json) &&
+	                     writer.Write(binaryHeader, sizeof(binaryHeader)) &&
+	                     writer.Write(model.vertices.data(), vertexSize, model.vertices.size()) &&
+	                     writer.Write(model.indices.data(), indexSize, model.indices.size() / 3);
+
+	return writer.Close() && success;
+}
\ No newline at end of file
@@ -0,0 +1,8 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include "../declarations/structures.h"
+#include "progress.h"
+
+// Write the model as a binary glTF, with the vertex and index arrays copied into its buffer as they are held in memory.
+bool WriteGlb(const char* filePath, const Model& model, ExportProgress& progress);
\ No newline at end of file
@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "mesh.h"
+
+MeshWriter::MeshWriter(ExportProgress& progress) : m_progress(progress) {}
+
+bool MeshWriter::Open(const char* filePath, const uint64_t size)
+{
+	m_offset = 0;
+
+	return m_file.Open(filePath) && (size == 0 || m_file.Reserve(size));
+}
+
+bool MeshWriter::Write(const void* data, const size_t size, const uint64_t items)
+{
+	const auto* bytes = static_cast<const unsigned char*>(data);
+	const size_t pieceCount = (size + MESH_WRITE_SIZE - 1) / MESH_WRITE_SIZE;
+	std::atomic<bool> success = true;
+
+	// Large arrays are split between threads, each copying its share into the file at its own offset.
+	ParallelFor(
+		pieceCount,
+		[&](const size_t begin, const size_t end) {
+			for (size_t piece = begin; piece < end && success; piece++) {
+				const size_t first = piece * MESH_WRITE_SIZE;
+				const size_t last = std::min(first + MESH_WRITE_SIZE, size);
+
+				if (m_progress.IsCancelled() || !m_file.WriteAt(bytes + first, last - first, m_offset + first)) {
+					success = false;
+				}
+
+				m_progress.Advance(items * (last - first) / size);
+			}
+		},
+		8);
+
+	m_offset += size;
+
+	return success;
+}
+
+bool MeshWriter::Write(const std::string& text)
+{
+	return Write(text.data(), text.size());
+}
+
+bool MeshWriter::Close()
+{
+	return m_file.Close();
+}
\ No newline at end of file
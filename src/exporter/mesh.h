@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "../parallel.h"
+#include "blocks.h"
+#include "file.h"
+#include "progress.h"
+
+// The size of each piece of output written by a thread at a time.
+constexpr size_t MESH_WRITE_SIZE = 1 << 20;
+
+// Streams a mesh into a file front to back for the format specific writers. Data already laid out as the format
+// stores it, such as the little endian vertex and index arrays of a model, is written straight from memory by several
+// threads at once, while anything to be encoded first is encoded in parallel, so writing is bound by the disk rather
+// than by the work done per facet. Every write advances the progress of the export by the items it holds and fails once
+// the export is cancelled.
+class MeshWriter {
+public:
+	explicit MeshWriter(ExportProgress& progress);
+
+	// Create the file, claiming its full size upfront when it is known.
+	bool Open(const char* filePath, uint64_t size = 0);
+	// Append bytes as they are, holding the given number of items.
+	bool Write(const void* data, size_t size, uint64_t items = 0);
+	bool Write(const std::string& text);
+
+	// Append count records of exactly recordSize bytes. Every thread encodes its records with encode(begin, end,
+	// output) into a buffer and writes them directly into their place in the file.
+	template <typename Encode>
+	bool WriteRecords(size_t count, size_t recordSize, const Encode& encode);
+	// Append count items of variable length, such as lines of text, encoded in blocks by encode(begin, end, buffer).
+	template <typename Encode>
+	bool WriteText(size_t count, size_t blockSize, const Encode& encode);
+
+	bool Close();
+private:
+	ExportProgress& m_progress;
+	OutputFile m_file;
+	uint64_t m_offset = 0;
+};
+
+template <typename Encode>
+bool MeshWriter::WriteRecords(const size_t count, const size_t recordSize, const Encode& encode)
+{
+	const size_t recordsPerWrite = std::max<size_t>(1, MESH_WRITE_SIZE / recordSize);
+	std::atomic<bool> success = true;
+
+	ParallelFor(
+		count,
+		[&](const size_t begin, const size_t end) {
+			const auto buffer = std::make_unique<unsigned char[]>(recordsPerWrite * recordSize);
+
+			for (size_t first = begin; first < end && success; first += recordsPerWrite) {
+				const size_t last = std::min(first + recordsPerWrite, end);
+
+				encode(first, last, buffer.get());
+
+				if (m_progress.IsCancelled() ||
+				    !m_file.WriteAt(buffer.get(), (last - first) * recordSize, m_offset + first * recordSize)) {
+					success = false;
+				}
+
+				m_progress.Advance(last - first);
+			}
+		},
+		recordsPerWrite);
+
+	m_offset += count * recordSize;
+
+	return success;
+}
+
+template <typename Encode>
+bool MeshWriter::WriteText(const size_t count, const size_t blockSize, const Encode& encode)
+{
+	const auto write = [this](const char* data, const size_t size) {
+		if (!m_file.WriteAt(data, size, m_offset)) {
+			return false;
+		}
+
+		m_offset += size;
+		return true;
+	};
+
+	return EncodeBlocks(count, blockSize, encode, write, m_progress);
+}
\ No newline at end of file
@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "native.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "../parallel.h"
+#include "mesh.h"
+
+constexpr char MESH_FILE_MAGIC[8] = {'L', 'G', 'M', 'E', 'S', 'H', '\0', '\0'};
+
+// The arrays are stored as raw memory, which only matches between machines of the same byte order, and the header
+// layout must never change without a new version.
+static_assert(std::endian::native == std::endian::little);
+static_assert(sizeof(MeshFileHeader) == 136 && sizeof(MeshSettings) == 72);
+
+uint64_t AlignMeshOffset(const uint64_t offset)
+{
+	return (offset + MESH_FILE_ALIGNMENT - 1) & ~(MESH_FILE_ALIGNMENT - 1);
+}
+
+bool WriteMeshFile(const char* filePath, const Model& model, ExportProgress& progress)
+{
+	const uint64_t vertexSize = model.vertices.size() * sizeof(Vertex);
+	const uint64_t indexSize = model.indices.size() * sizeof(uint32_t);
+
+	MeshFileHeader header = {};
+	memcpy(header.magic, MESH_FILE_MAGIC, sizeof(MESH_FILE_MAGIC));
+	header.version = MESH_FILE_VERSION;
+	header.vertexSize = sizeof(Vertex);
+	header.vertexCount = model.vertices.size();
+	header.indexCount = model.indices.size();
+	header.vertexOffset = AlignMeshOffset(sizeof(MeshFileHeader));
+	header.indexOffset = AlignMeshOffset(header.vertexOffset + vertexSize);
+	header.centerOffset[0] = model.centerOffset.x;
+	header.centerOffset[1] = model.centerOffset.y;
+	header.centerOffset[2] = model.centerOffset.z;
+	header.settings = model.settings;
+
+	// The header is padded out to the vertices, and the vertices to the indices.
+	std::string start(header.vertexOffset, '\0');
+	memcpy(start.data(), &header, sizeof(MeshFileHeader));
+
+	const std::string padding(header.indexOffset - header.vertexOffset - vertexSize, '\0');
+
+	progress.SetTotal(model.vertices.size() + model.indices.size() / 3);
+	MeshWriter writer(progress);
+
+	if (!writer.Open(filePath, header.indexOffset + indexSize)) {
+		return false;
+	}
+
+	const bool success = writer.Write(start) &&
+	                     writer.Write(model.vertices.data(), vertexSize, model.vertices.size()) &&
+	                     writer.Write(padding) &&
+	                     writer.Write(model.indices.data(), indexSize, model.indices.size() / 3);
+
+	return writer.Close() && success;
+}
+
+bool MeshFile::Open(const char* filePath)
+{
+	Close();
+
+	if (!m_file.Open(filePath)) {
+		return false;
+	}
+
+	if (m_file.GetSize() < sizeof(MeshFileHeader)) {
+		std::cout << "Mesh file \"" << filePath << "\" is truncated!\n";
+		Close();
+		return false;
+	}
+
+	memcpy(&m_header, m_file.GetData(), sizeof(MeshFileHeader));
+
+	if (memcmp(m_header.magic, MESH_FILE_MAGIC, sizeof(MESH_FILE_MAGIC)) != 0 ||
+	    m_header.version != MESH_FILE_VERSION || m_header.vertexSize != sizeof(Vertex)) {
+		std::cout << "File \"" << filePath << "\" is not a supported mesh file!\n";
+		Close();
+		return false;
+	}
+
+	// Guard against overflow as well as arrays running past the end of the file.
+	const uint64_t fileSize = m_file.GetSize();
+	const bool verticesFit = m_header.vertexOffset <= fileSize &&
+	                         m_header.vertexCount <= (fileSize - m_header.vertexOffset) / sizeof(Vertex);
+	const bool indicesFit = m_header.indexOffset <= fileSize &&
+	                        m_header.indexCount <= (fileSize - m_header.indexOffset) / sizeof(uint32_t);
+	const bool aligned = m_header.vertexOffset % alignof(Vertex) == 0 && m_header.indexOffset % alignof(uint32_t) == 0;
+
+	if (!verticesFit || !indicesFit || !aligned || m_header.indexCount % 3 != 0) {
+		std::cout << "Mesh file \"" << filePath << "\" is corrupt!\n";
+		Close();
+		return false;
+	}
+
+	// Indices pointing outside the vertices would be read out of bounds by the GPU and every exporter. This is the only
+	// pass over the data, split between threads as it runs at the speed of memory.
+	const uint32_t* indices = GetIndices();
+	std::atomic<bool> inBounds = true;
+
+	ParallelFor(
+		m_header.indexCount,
+		[&](const size_t begin, const size_t end) {
+			const uint64_t vertexCount = m_header.vertexCount;
+
+			if (!std::all_of(indices + begin, indices + end,
+			                 [vertexCount](const uint32_t index) { return index < vertexCount; })) {
+				inBounds = false;
+			}
+		},
+		1 << 20);
+
+	if (!inBounds) {
+		std::cout << "Mesh file \"" << filePath << "\" is corrupt!\n";
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void MeshFile::Close()
+{
+	m_file.Close();
+	m_header = {};
+}
+
+const MeshFileHeader& MeshFile::GetHeader() const
+{
+	return m_header;
+}
+
+const Vertex* MeshFile::GetVertices() const
+{
+	return reinterpret_cast<const Vertex*>(m_file.GetData() + m_header.vertexOffset);
+}
+
+const uint32_t* MeshFile::GetIndices() const
+{
+	return reinterpret_cast<const uint32_t*>(m_file.GetData() + m_header.indexOffset);
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include <cstdint>
+#include "../declarations/structures.h"
+#include "../mapping.h"
+#include "progress.h"
+
+// The version of the mesh file layout, bumped whenever it changes.
+constexpr uint32_t MESH_FILE_VERSION = 1;
+
+// Every section of a mesh file starts on a page boundary, so a mapping of it can be handed to the GPU as is.
+constexpr uint64_t MESH_FILE_ALIGNMENT = 4096;
+
+// The start of a native LithoGen mesh file. The vertex and index arrays follow at their offsets, laid out exactly as a
+// Model holds them in memory.
+struct MeshFileHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t vertexSize;
+	uint64_t vertexCount;
+	uint64_t indexCount;
+	uint64_t vertexOffset;
+	uint64_t indexOffset;
+	float centerOffset[3];
+	uint32_t reserved;
+	MeshSettings settings;
+};
+
+// Write the model with the settings it was compiled from as a native mesh file.
+bool WriteMeshFile(const char* filePath, const Model& model, ExportProgress& progress);
+
+// A native mesh file mapped into memory, whose arrays are read in place without any parsing.
+class MeshFile {
+public:
+	MeshFile() = default;
+
+	// Map and validate a file by its UTF-8 path.
+	bool Open(const char* filePath);
+	void Close();
+
+	[[nodiscard]] const MeshFileHeader& GetHeader() const;
+	[[nodiscard]] const Vertex* GetVertices() const;
+	[[nodiscard]] const uint32_t* GetIndices() const;
+private:
+	MappedFile m_file;
+	MeshFileHeader m_header = {};
+};
\ No newline at end of file
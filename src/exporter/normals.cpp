@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "normals.h"
+#include <cmath>
+#include <glm/geometric.hpp>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define NORMALS_SSE
+#include <xmmintrin.h>
+#endif
+
+glm::vec3 ComputeFacetNormal(const glm::vec3& first, const glm::vec3& second, const glm::vec3& third)
+{
+	const glm::vec3 normal = glm::cross(second - first, third - first);
+	const float lengthSquared = glm::dot(normal, normal);
+
+	return lengthSquared > 0.0F ? normal / std::sqrt(lengthSquared) : glm::vec3(0.0F);
+}
+
+#ifdef NORMALS_SSE
+
+// Load a corner of four facets as a structure of arrays, one register per axis.
+void LoadCorners(const Vertex* vertices, const uint32_t* indices, const size_t corner, __m128& x, __m128& y,
+                 __m128& z)
+{
+	const glm::vec3& position0 = vertices[indices[corner]].position;
+	const glm::vec3& position1 = vertices[indices[3 + corner]].position;
+	const glm::vec3& position2 = vertices[indices[6 + corner]].position;
+	const glm::vec3& position3 = vertices[indices[9 + corner]].position;
+
+	x = _mm_setr_ps(position0.x, position1.x, position2.x, position3.x);
+	y = _mm_setr_ps(position0.y, position1.y, position2.y, position3.y);
+	z = _mm_setr_ps(position0.z, position1.z, position2.z, position3.z);
+}
+
+#endif
+
+void ComputeFacetNormals(const Model& model, const size_t firstFacet, const size_t count, glm::vec3* normals)
+{
+	const Vertex* vertices = model.vertices.data();
+	const uint32_t* indices = model.indices.data() + firstFacet * 3;
+	size_t facet = 0;
+
+#ifdef NORMALS_SSE
+	for (; facet + 4 <= count; facet += 4, indices += 12) {
+		__m128 firstX, firstY, firstZ;
+		__m128 secondX, secondY, secondZ;
+		__m128 thirdX, thirdY, thirdZ;
+
+		LoadCorners(vertices, indices, 0, firstX, firstY, firstZ);
+		LoadCorners(vertices, indices, 1, secondX, secondY, secondZ);
+		LoadCorners(vertices, indices, 2, thirdX, thirdY, thirdZ);
+
+		const __m128 edgeX = _mm_sub_ps(secondX, firstX);
+		const __m128 edgeY = _mm_sub_ps(secondY, firstY);
+		const __m128 edgeZ = _mm_sub_ps(secondZ, firstZ);
+		const __m128 otherEdgeX = _mm_sub_ps(thirdX, firstX);
+		const __m128 otherEdgeY = _mm_sub_ps(thirdY, firstY);
+		const __m128 otherEdgeZ = _mm_sub_ps(thirdZ, firstZ);
+
+		const __m128 normalX = _mm_sub_ps(_mm_mul_ps(edgeY, otherEdgeZ), _mm_mul_ps(edgeZ, otherEdgeY));
+		const __m128 normalY = _mm_sub_ps(_mm_mul_ps(edgeZ, otherEdgeX), _mm_mul_ps(edgeX, otherEdgeZ));
+		const __m128 normalZ = _mm_sub_ps(_mm_mul_ps(edgeX, otherEdgeY), _mm_mul_ps(edgeY, otherEdgeX));
+
+		const __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(normalX, normalX), _mm_mul_ps(normalY, normalY)),
+		                                        _mm_mul_ps(normalZ, normalZ));
+
+		// The reciprocal square root estimate is refined with a Newton-Raphson step to near full float precision, then
+		// zeroed for degenerate facets whose estimate is infinite.
+		const __m128 estimate = _mm_rsqrt_ps(lengthSquared);
+		const __m128 refinement = _mm_sub_ps(
+			_mm_set1_ps(1.5F),
+			_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5F), lengthSquared), _mm_mul_ps(estimate, estimate)));
+		const __m128 scale = _mm_and_ps(_mm_mul_ps(estimate, refinement),
+		                                _mm_cmpgt_ps(lengthSquared, _mm_setzero_ps()));
+
+		alignas(16) float x[4];
+		alignas(16) float y[4];
+		alignas(16) float z[4];
+		_mm_store_ps(x, _mm_mul_ps(normalX, scale));
+		_mm_store_ps(y, _mm_mul_ps(normalY, scale));
+		_mm_store_ps(z, _mm_mul_ps(normalZ, scale));
+
+		for (size_t lane = 0; lane < 4; lane++) {
+			normals[facet + lane] = glm::vec3(x[lane], y[lane], z[lane]);
+		}
+	}
+#endif
+
+	for (; facet < count; facet++, indices += 3) {
+		normals[facet] = ComputeFacetNormal(vertices[indices[0]].position, vertices[indices[1]].position,
+		                                    vertices[indices[2]].position);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include <cstddef>
+#include "../declarations/structures.h"
+
+// The facets exporters compute normals for at a time, few enough for the normals to be kept on the stack.
+constexpr size_t NORMAL_BATCH_SIZE = 256;
+
+// Compute the unit normals of count facets from firstFacet, pointing out of the mesh as given by the counter-clockwise
+// winding. Degenerate facets are given a zero normal. Where SSE is available four facets are computed at once.
+void ComputeFacetNormals(const Model& model, size_t firstFacet, size_t count, glm::vec3* normals);
\ No newline at end of file
@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "obj.h"
+#include <string>
+#include "mesh.h"
+#include "normals.h"
+
+// The vertices or faces formatted into each block of output.
+constexpr size_t OBJ_ITEMS_PER_BLOCK = 32768;
+
+// Enough for any line, allowing the longest float or index for every element. Faces reference a vertex and a normal
+// for each corner.
+constexpr size_t OBJ_LINE_MAX_SIZE = 72;
+constexpr size_t OBJ_FACE_MAX_SIZE = 136;
+
+void EncodeObjVertices(const Model& model, const size_t begin, const size_t end, std::string& buffer)
+{
+	buffer.resize((end - begin) * OBJ_LINE_MAX_SIZE);
+
+	char* output = buffer.data();
+
+	for (size_t vertex = begin; vertex < end; vertex++) {
+		const glm::vec3& position = model.vertices[vertex].position;
+
+		output = AppendText(output, "v ");
+		output = FormatFloat(output, position.x);
+		*output++ = ' ';
+		output = FormatFloat(output, position.y);
+		*output++ = ' ';
+		output = FormatFloat(output, position.z);
+		*output++ = '\n';
+	}
+
+	buffer.resize(output - buffer.data());
+}
+
+void EncodeObjNormals(const Model& model, const size_t begin, const size_t end, std::string& buffer)
+{
+	buffer.resize((end - begin) * OBJ_LINE_MAX_SIZE);
+
+	char* output = buffer.data();
+	glm::vec3 normals[NORMAL_BATCH_SIZE];
+
+	for (size_t batch = begin; batch < end; batch += NORMAL_BATCH_SIZE) {
+		const size_t batchCount = std::min(NORMAL_BATCH_SIZE, end - batch);
+		ComputeFacetNormals(model, batch, batchCount, normals);
+
+		for (size_t face = 0; face < batchCount; face++) {
+			output = AppendText(output, "vn ");
+			output = FormatFloat(output, normals[face].x);
+			*output++ = ' ';
+			output = FormatFloat(output, normals[face].y);
+			*output++ = ' ';
+			output = FormatFloat(output, normals[face].z);
+			*output++ = '\n';
+		}
+	}
+
+	buffer.resize(output - buffer.data());
+}
+
+void EncodeObjFaces(const Model& model, const size_t begin, const size_t end, std::string& buffer)
+{
+	buffer.resize((end - begin) * OBJ_FACE_MAX_SIZE);
+
+	char* output = buffer.data();
+
+	for (size_t face = begin; face < end; face++) {
+		const uint32_t* indices = model.indices.data() + face * 3;
+
+		// OBJ counts vertices and normals from one, every face has the normal of the same index.
+		output = AppendText(output, "f");
+
+		for (size_t corner = 0; corner < 3; corner++) {
+			*output++ = ' ';
+			output = FormatInteger(output, indices[corner] + uint64_t{1});
+			output = AppendText(output, "//");
+			output = FormatInteger(output, face + 1);
+		}
+
+		*output++ = '\n';
+	}
+
+	buffer.resize(output - buffer.data());
+}
+
+bool WriteObj(const char* filePath, const Model& model, ExportProgress& progress)
+{
+	const size_t faceCount = model.indices.size() / 3;
+	progress.SetTotal(model.vertices.size() + faceCount * 2);
+	MeshWriter writer(progress);
+
+	if (!writer.Open(filePath)) {
+		return false;
+	}
+
+	const auto encodeVertices = [&model](const size_t begin, const size_t end, std::string& buffer) {
+		EncodeObjVertices(model, begin, end, buffer);
+	};
+
+	const auto encodeNormals = [&model](const size_t begin, const size_t end, std::string& buffer) {
+		EncodeObjNormals(model, begin, end, buffer);
+	};
+
+	const auto encodeFaces = [&model](const size_t begin, const size_t end, std::string& buffer) {
+		EncodeObjFaces(model, begin, end, buffer);
+	};
+
+	const bool success = writer.Write("# Exported by LithoGen\no lithophane\n") &&
+	                     writer.WriteText(model.vertices.size(), OBJ_ITEMS_PER_BLOCK, encodeVertices) &&
+	                     writer.WriteText(faceCount, OBJ_ITEMS_PER_BLOCK, encodeNormals) &&
+	                     writer.WriteText(faceCount, OBJ_ITEMS_PER_BLOCK, encodeFaces);
+
+	return writer.Close() && success;
+}
\ No newline at end of file
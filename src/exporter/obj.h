@@ -0,0 +1,8 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include "../declarations/structures.h"
+#include "progress.h"
+
+// Write the model as a Wavefront OBJ with a normal per face, formatting blocks of lines in parallel.
+bool WriteObj(const char* filePath, const Model& model, ExportProgress& progress);
\ No newline at end of file
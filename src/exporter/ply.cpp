@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "ply.h"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include "mesh.h"
+
+// Every vertex is three 32-bit float coordinates followed by an 8-bit red, green and blue.
+constexpr size_t PLY_VERTEX_SIZE = 15;
+
+// Every face is a one byte vertex count followed by three 32-bit indices.
+constexpr size_t PLY_FACE_SIZE = 13;
+
+// Values are copied out as raw floats and integers, which is only the format declared on a little endian machine.
+static_assert(std::endian::native == std::endian::little);
+
+// Colours are written as bytes, the type MeshLab, Blender and CloudCompare expect for red, green and blue.
+void EncodePlyVertices(const Model& model, const size_t begin, const size_t end, unsigned char* output)
+{
+	for (size_t vertex = begin; vertex < end; vertex++, output += PLY_VERTEX_SIZE) {
+		const Vertex& source = model.vertices[vertex];
+		memcpy(output, &source.position, 3 * sizeof(float));
+
+		for (int channel = 0; channel < 3; channel++) {
+			const float value = std::clamp(source.color[channel], 0.0F, 1.0F);
+			output[12 + channel] = static_cast<unsigned char>(value * 255.0F + 0.5F);
+		}
+	}
+}
+
+void EncodePlyFaces(const Model& model, const size_t begin, const size_t end, unsigned char* output)
+{
+	for (size_t face = begin; face < end; face++, output += PLY_FACE_SIZE) {
+		output[0] = 3;
+		memcpy(output + 1, &model.indices[face * 3], 3 * sizeof(uint32_t));
+	}
+}
+
+bool WritePly(const char* filePath, const Model& model, ExportProgress& progress)
+{
+	const size_t faceCount = model.indices.size() / 3;
+
+	const std::string header = "ply\n"
+	                           "format binary_little_endian 1.0\n"
+	                           "comment Exported by LithoGen\n"
+	                           "element vertex " + std::to_string(model.vertices.size()) + "\n"
+	                           "property float x\n"
+	                           "property float y\n"
+	                           "property float z\n"
+	                           "property uchar red\n"
+	                           "property uchar green\n"
+	                           "property uchar blue\n"
+	                           "element face " + std::to_string(faceCount) + "\n"
+	                           "property list uchar uint vertex_indices\n"
+	                           "end_header\n";
+
+	const uint64_t vertexSize = model.vertices.size() * PLY_VERTEX_SIZE;
+
+	progress.SetTotal(model.vertices.size() + faceCount);
+	MeshWriter writer(progress);
+
+	if (!writer.Open(filePath, header.size() + vertexSize + faceCount * PLY_FACE_SIZE)) {
+		return false;
+	}
+
+	const auto encodeVertices = [&model](const size_t begin, const size_t end, unsigned char* output) {
+		EncodePlyVertices(model, begin, end, output);
+	};
+	const auto encodeFaces = [&model](const size_t begin, const size_t end, unsigned char* output) {
+		EncodePlyFaces(model, begin, end, output);
+	};
+
+	const bool success = writer.Write(header) &&
+	                     writer.WriteRecords(model.vertices.size(), PLY_VERTEX_SIZE, encodeVertices) &&
+	                     writer.WriteRecords(faceCount, PLY_FACE_SIZE, encodeFaces);
+
+	return writer.Close() && success;
+}
\ No newline at end of file
@@ -0,0 +1,8 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include "../declarations/structures.h"
+#include "progress.h"
+
+// Write the model as a binary little endian PLY, with the vertex array copied out as it is held in memory.
+bool WritePly(const char* filePath, const Model& model, ExportProgress& progress);
\ No newline at end of file
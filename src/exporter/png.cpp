@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "png.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "deflate.h"
+
+constexpr unsigned char PNG_SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+// Each row is stored as its difference from the row above, so the long runs of identical rows in a mask become zeroes.
+constexpr unsigned char PNG_FILTER_UP = 2;
+
+// The largest number of bytes the Adler-32 sums can take before they must be reduced to avoid overflowing.
+constexpr size_t ADLER_BLOCK_SIZE = 5552;
+constexpr uint32_t ADLER_MODULUS = 65521;
+
+uint32_t Adler32(const unsigned char* data, size_t size)
+{
+	uint32_t a = 1;
+	uint32_t b = 0;
+
+	while (size > 0) {
+		const size_t block = std::min(size, ADLER_BLOCK_SIZE);
+
+		for (size_t index = 0; index < block; index++) {
+			a += data[index];
+			b += a;
+		}
+
+		a %= ADLER_MODULUS;
+		b %= ADLER_MODULUS;
+		data += block;
+		size -= block;
+	}
+
+	return (b << 16) | a;
+}
+
+// PNG stores every integer big endian.
+void PutBigU32(std::string& output, const uint32_t value)
+{
+	output.push_back(static_cast<char>(value >> 24));
+	output.push_back(static_cast<char>((value >> 16) & 0xFF));
+	output.push_back(static_cast<char>((value >> 8) & 0xFF));
+	output.push_back(static_cast<char>(value & 0xFF));
+}
+
+// Complete the chunk starting at chunkStart, filling in the length of the data appended after its type and appending
+// the checksum.
+void FinishChunk(std::string& output, const size_t chunkStart)
+{
+	const size_t dataSize = output.size() - chunkStart - 8;
+	const auto* type = reinterpret_cast<const unsigned char*>(output.data() + chunkStart + 4);
+
+	for (int shift = 24, offset = 0; shift >= 0; shift -= 8, offset++) {
+		output[chunkStart + offset] = static_cast<char>((dataSize >> shift) & 0xFF);
+	}
+
+	PutBigU32(output, Crc32(0, type, dataSize + 4));
+}
+
+void EncodeGrayscalePng(const unsigned char* pixels, const int width, const int height, std::string& output)
+{
+	const size_t rowSize = static_cast<size_t>(width);
+
+	std::vector<unsigned char> filtered((rowSize + 1) * height);
+
+	for (int row = 0; row < height; row++) {
+		const unsigned char* current = pixels + row * rowSize;
+		unsigned char* target = filtered.data() + row * (rowSize + 1);
+
+		target[0] = PNG_FILTER_UP;
+
+		for (size_t column = 0; column < rowSize; column++) {
+			target[column + 1] = row == 0 ? current[column] : current[column] - current[column - rowSize];
+		}
+	}
+
+	output.assign(reinterpret_cast<const char*>(PNG_SIGNATURE), sizeof(PNG_SIGNATURE));
+
+	size_t chunkStart = output.size();
+	output.append("\0\0\0\0IHDR", 8);
+	PutBigU32(output, static_cast<uint32_t>(width));
+	PutBigU32(output, static_cast<uint32_t>(height));
+	output.append("\x08\0\0\0\0", 5); // 8-bit grayscale, deflate, adaptive filtering and no interlacing.
+	FinishChunk(output, chunkStart);
+
+	// The image data is a zlib stream, a two byte header then raw deflate followed by the Adler-32 of the input.
+	chunkStart = output.size();
+	output.append("\0\0\0\0IDAT\x78\x01", 10);
+	DeflateChunk(filtered.data(), filtered.size(), 0, true, output);
+	PutBigU32(output, Adler32(filtered.data(), filtered.size()));
+	FinishChunk(output, chunkStart);
+
+	chunkStart = output.size();
+	output.append("\0\0\0\0IEND", 8);
+	FinishChunk(output, chunkStart);
+}
\ No newline at end of file
@@ -0,0 +1,8 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include <string>
+
+// Encode an 8-bit grayscale image as a PNG, replacing the contents of output. Rows are tightly packed. Nothing is
+// shared between calls, so separate images may be encoded on separate threads.
+void EncodeGrayscalePng(const unsigned char* pixels, int width, int height, std::string& output);
\ No newline at end of file
@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+// The progress of an export, advanced by the threads writing it and read by the interface, which may also cancel it.
+// Progress is counted in whatever units the format writes, usually vertices and faces.
+class ExportProgress {
+public:
+	void SetTotal(const uint64_t total)
+	{
+		m_total = total;
+		m_done = 0;
+	}
+
+	void Advance(const uint64_t units)
+	{
+		m_done += units;
+	}
+
+	[[nodiscard]] float GetFraction() const
+	{
+		const uint64_t total = m_total;
+
+		return total == 0 ? 0.0F : std::min(1.0F, static_cast<float>(m_done) / static_cast<float>(total));
+	}
+
+	void Cancel()
+	{
+		m_cancelled = true;
+	}
+
+	[[nodiscard]] bool IsCancelled() const
+	{
+		return m_cancelled;
+	}
+private:
+	std::atomic<uint64_t> m_total = 0;
+	std::atomic<uint64_t> m_done = 0;
+	std::atomic<bool> m_cancelled = false;
+};
\ No newline at end of file
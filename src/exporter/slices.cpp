@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "slices.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include "../parallel.h"
+#include "png.h"
+#include "zip.h"
+
+// The layers each thread encodes per batch, bounding how many finished images are held before they are written.
+constexpr size_t SLICE_LAYERS_PER_THREAD = 4;
+
+// Bilinearly sample the depth map at a position in pixels, where pixel centres lie on whole coordinates.
+float SampleDepth(const std::vector<float>& depthMap, const int width, const int height, const float x, const float y)
+{
+	const float clampedX = std::clamp(x, 0.0F, static_cast<float>(width - 1));
+	const float clampedY = std::clamp(y, 0.0F, static_cast<float>(height - 1));
+	const int left = static_cast<int>(clampedX);
+	const int top = static_cast<int>(clampedY);
+	const int right = std::min(left + 1, width - 1);
+	const int bottom = std::min(top + 1, height - 1);
+	const float fractionX = clampedX - left;
+	const float fractionY = clampedY - top;
+
+	const float* upper = depthMap.data() + static_cast<size_t>(top) * width;
+	const float* lower = depthMap.data() + static_cast<size_t>(bottom) * width;
+	const float upperDepth = upper[left] + (upper[right] - upper[left]) * fractionX;
+	const float lowerDepth = lower[left] + (lower[right] - lower[left]) * fractionX;
+
+	return upperDepth + (lowerDepth - upperDepth) * fractionY;
+}
+
+// A layer is solid wherever its centre lies within the thickness.
+int GetSolidLayers(const float thickness, const float layerHeight)
+{
+	return static_cast<int>(std::ceil(thickness / layerHeight - 0.5F));
+}
+
+bool WriteLayerSlices(const char* filePath, const std::vector<float>& depthMap, const int width, const int height,
+                      const Config* config, ExportProgress& progress)
+{
+	// The slices are sized like the mesh, by its width with square source pixels.
+	const float sourcePixelSize = config->sliderWidth / width;
+	const float pixelSize = config->slicePixelSize;
+	const float layerHeight = config->sliceLayerHeight;
+	const float scale = pixelSize / sourcePixelSize;
+
+	const int outputWidth = std::max(1, static_cast<int>(std::lround(config->sliderWidth / pixelSize)));
+	const int outputHeight = std::max(1, static_cast<int>(std::lround(height * sourcePixelSize / pixelSize)));
+	const int layerCount = std::max(1, GetSolidLayers(config->sliderThickMax, layerHeight));
+
+	// The thickness of each output pixel is found once as its count of solid layers, every layer is a threshold of it.
+	std::vector<uint32_t> solidLayers(static_cast<size_t>(outputWidth) * outputHeight);
+	const float thickRange = config->sliderThickMax - config->sliderThickMin;
+
+	ParallelFor(
+		static_cast<size_t>(outputHeight),
+		[&](const size_t begin, const size_t end) {
+			for (size_t row = begin; row < end; row++) {
+				uint32_t* output = solidLayers.data() + row * outputWidth;
+				const float y = (static_cast<float>(row) + 0.5F) * scale - 0.5F;
+
+				for (int column = 0; column < outputWidth; column++) {
+					const float x = (static_cast<float>(column) + 0.5F) * scale - 0.5F;
+
+					// Depths run from zero at the thinnest to minus one at the thickest.
+					const float depth = SampleDepth(depthMap, width, height, x, y);
+					const int solid = GetSolidLayers(config->sliderThickMin - depth * thickRange, layerHeight);
+
+					output[column] = static_cast<uint32_t>(std::clamp(solid, 0, layerCount));
+				}
+			}
+		},
+		16);
+
+	ZipWriter archive;
+
+	if (!archive.Open(filePath)) {
+		return false;
+	}
+
+	char description[256];
+	const int descriptionSize =
+		snprintf(description, sizeof(description),
+		         "application = LithoGen\nlayerHeight = %g\npixelSize = %g\nresolutionX = %d\nresolutionY = %d\n"
+		         "layerCount = %d\n",
+		         layerHeight, pixelSize, outputWidth, outputHeight, layerCount);
+
+	bool success = archive.BeginEntry("config.ini", false) && archive.Write(description, descriptionSize) &&
+	               archive.EndEntry();
+
+	progress.SetTotal(layerCount);
+
+	const size_t batchSize = std::max(1U, std::thread::hardware_concurrency()) * SLICE_LAYERS_PER_THREAD;
+	std::vector<std::string> images(batchSize);
+
+	for (size_t first = 0; success && first < static_cast<size_t>(layerCount); first += batchSize) {
+		if (progress.IsCancelled()) {
+			success = false;
+			break;
+		}
+
+		const size_t count = std::min(batchSize, layerCount - first);
+
+		ParallelFor(count, [&](const size_t begin, const size_t end) {
+			std::vector<unsigned char> mask(solidLayers.size());
+
+			for (size_t image = begin; image < end; image++) {
+				const size_t layer = first + image;
+
+				std::ranges::transform(solidLayers, mask.begin(), [layer](const uint32_t solid) {
+					return static_cast<unsigned char>(solid > layer ? 255 : 0);
+				});
+
+				EncodeGrayscalePng(mask.data(), outputWidth, outputHeight, images[image]);
+				progress.Advance(1);
+			}
+		});
+
+		// The images are already compressed, so they are stored as they are.
+		for (size_t image = 0; success && image < count; image++) {
+			char name[32];
+			snprintf(name, sizeof(name), "layer%05zu.png", first + image);
+
+			success = archive.AddStoredEntry(name, images[image].data(), images[image].size());
+		}
+	}
+
+	return archive.Close() && success;
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include <vector>
+#include "../declarations/config.h"
+#include "progress.h"
+
+// Slice the height field of a depth map straight into the layer images a resin printer exposes, without building a
+// mesh. The archive holds a PNG mask per layer, numbered from the build plate up, along with a config.ini describing
+// the pixel size and layer height. Layers are rasterised and encoded in parallel.
+bool WriteLayerSlices(const char* filePath, const std::vector<float>& depthMap, int width, int height,
+                      const Config* config, ExportProgress& progress);
\ No newline at end of file
@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "stl.h"
+#include <bit>
+#include <cstring>
+#include <limits>
+#include "mesh.h"
+#include "normals.h"
+
+// Binary STL is a fixed 80 byte header and 32-bit facet count, followed by 50 bytes per facet.
+constexpr size_t STL_HEADER_SIZE = 84;
+constexpr size_t STL_FACET_SIZE = 50;
+
+// The facets formatted into each block of ASCII output.
+constexpr size_t STL_ASCII_FACETS_PER_BLOCK = 16384;
+
+// Enough for any facet. Its fixed text is 92 characters, and it has four lines of three floats with two spaces and a
+// newline each. The shortest round trip form std::to_chars gives a float is at most 15 characters, reached by a
+// negative nine digit exponent form such as -1.00211145e-36, as the plain form is only used when it is shorter.
+constexpr size_t STL_ASCII_FACET_MAX_SIZE = 92 + 4 * (3 * 15 + 3);
+
+// Facets are copied out as raw floats, which is only the format STL expects on a little endian machine.
+static_assert(std::endian::native == std::endian::little);
+
+void EncodeBinaryFacets(const Model& model, const size_t firstFacet, const size_t facetCount, unsigned char* output)
+{
+	const uint32_t* indices = model.indices.data() + firstFacet * 3;
+	const Vertex* vertices = model.vertices.data();
+	glm::vec3 normals[NORMAL_BATCH_SIZE];
+
+	for (size_t batch = 0; batch < facetCount; batch += NORMAL_BATCH_SIZE) {
+		const size_t batchCount = std::min(NORMAL_BATCH_SIZE, facetCount - batch);
+		ComputeFacetNormals(model, firstFacet + batch, batchCount, normals);
+
+		for (size_t facet = 0; facet < batchCount; facet++, indices += 3, output += STL_FACET_SIZE) {
+			// The trailing attribute byte count is left zeroed.
+			memcpy(output, &normals[facet], 12);
+			memcpy(output + 12, &vertices[indices[0]].position, 12);
+			memcpy(output + 24, &vertices[indices[1]].position, 12);
+			memcpy(output + 36, &vertices[indices[2]].position, 12);
+			memset(output + 48, 0, 2);
+		}
+	}
+}
+
+bool WriteBinaryStl(const char* filePath, const Model& model, ExportProgress& progress)
+{
+	const size_t facetCount = model.indices.size() / 3;
+
+	if (facetCount > std::numeric_limits<uint32_t>::max()) {
+		return false;
+	}
+
+	progress.SetTotal(facetCount);
+	MeshWriter writer(progress);
+
+	// The final size is known exactly, so it can be claimed before any facet is written.
+	if (!writer.Open(filePath, STL_HEADER_SIZE + STL_FACET_SIZE * facetCount)) {
+		return false;
+	}
+
+	unsigned char header[STL_HEADER_SIZE] = {};
+	constexpr char headerText[] = "Binary STL exported by LithoGen";
+	memcpy(header, headerText, sizeof(headerText) - 1);
+
+	const auto facetCount32 = static_cast<uint32_t>(facetCount);
+	memcpy(header + 80, &facetCount32, sizeof(uint32_t));
+
+	const auto encode = [&model](const size_t begin, const size_t end, unsigned char* output) {
+		EncodeBinaryFacets(model, begin, end - begin, output);
+	};
+
+	const bool success =
+		writer.Write(header, STL_HEADER_SIZE) && writer.WriteRecords(facetCount, STL_FACET_SIZE, encode);
+
+	return writer.Close() && success;
+}
+
+// Append a line of three floats following a prefix, used for both the normal and the vertices of a facet.
+char* FormatVector(char* output, const char* prefix, const glm::vec3& vector)
+{
+	output = AppendText(output, prefix);
+
+	output = FormatFloat(output, vector.x);
+	*output++ = ' ';
+	output = FormatFloat(output, vector.y);
+	*output++ = ' ';
+	output = FormatFloat(output, vector.z);
+	*output++ = '\n';
+
+	return output;
+}
+
+void EncodeAsciiFacets(const Model& model, const size_t begin, const size_t end, std::string& buffer)
+{
+	buffer.resize((end - begin) * STL_ASCII_FACET_MAX_SIZE);
+
+	char* output = buffer.data();
+	glm::vec3 normals[NORMAL_BATCH_SIZE];
+
+	for (size_t batch = begin; batch < end; batch += NORMAL_BATCH_SIZE) {
+		const size_t batchCount = std::min(NORMAL_BATCH_SIZE, end - batch);
+		ComputeFacetNormals(model, batch, batchCount, normals);
+
+		for (size_t facet = 0; facet < batchCount; facet++) {
+			output = FormatVector(output, "  facet normal ", normals[facet]);
+			output = AppendText(output, "    outer loop\n");
+
+			for (size_t corner = 0; corner < 3; corner++) {
+				output = FormatVector(output, "      vertex ",
+				                      model.vertices[model.indices[(batch + facet) * 3 + corner]].position);
+			}
+
+			output = AppendText(output, "    endloop\n  endfacet\n");
+		}
+	}
+
+	buffer.resize(output - buffer.data());
+}
+
+bool WriteAsciiStl(const char* filePath, const Model& model, ExportProgress& progress)
+{
+	progress.SetTotal(model.indices.size() / 3);
+	MeshWriter writer(progress);
+
+	if (!writer.Open(filePath)) {
+		return false;
+	}
+
+	constexpr char solidStart[] = "solid lithophane\n";
+	constexpr char solidEnd[] = "endsolid lithophane\n";
+
+	const auto encode = [&model](const size_t begin, const size_t end, std::string& buffer) {
+		EncodeAsciiFacets(model, begin, end, buffer);
+	};
+
+	const bool success = writer.Write(solidStart, sizeof(solidStart) - 1) &&
+	                     writer.WriteText(model.indices.size() / 3, STL_ASCII_FACETS_PER_BLOCK, encode) &&
+	                     writer.Write(solidEnd, sizeof(solidEnd) - 1);
+
+	return writer.Close() && success;
+}
\ No newline at end of file
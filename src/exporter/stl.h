@@ -0,0 +1,10 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include "../declarations/structures.h"
+#include "progress.h"
+
+// Write the model as a binary STL, encoding ranges of facets in parallel straight into their final place in the file.
+bool WriteBinaryStl(const char* filePath, const Model& model, ExportProgress& progress);
+// Write the model as an ASCII STL, formatting blocks of facets in parallel and writing them out in order.
+bool WriteAsciiStl(const char* filePath, const Model& model, ExportProgress& progress);
\ No newline at end of file
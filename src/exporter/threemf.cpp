@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "threemf.h"
+#include <ctime>
+#include <string>
+#include "blocks.h"
+#include "zip.h"
+
+// The vertices or triangles formatted into each block of XML.
+constexpr size_t THREEMF_ITEMS_PER_BLOCK = 16384;
+
+// Enough for any vertex or triangle element, allowing the longest float or index for every attribute.
+constexpr size_t THREEMF_ITEM_MAX_SIZE = 128;
+
+constexpr char THREEMF_CONTENT_TYPES[] =
+	"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	"<Types xmlns=\"http://schemas.openxmlformats.org/package/2006/content-types\">\n"
+	" <Default Extension=\"rels\" ContentType=\"application/vnd.openxmlformats-package.relationships+xml\"/>\n"
+	" <Default Extension=\"model\" ContentType=\"application/vnd.ms-package.3dmanufacturing-3dmodel+xml\"/>\n"
+	"</Types>\n";
+
+constexpr char THREEMF_RELATIONSHIPS[] =
+	"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	"<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">\n"
+	" <Relationship Target=\"/3D/3dmodel.model\" Id=\"rel0\" "
+	"Type=\"http://schemas.microsoft.com/3dmanufacturing/2013/01/3dmodel\"/>\n"
+	"</Relationships>\n";
+
+constexpr char THREEMF_MODEL_END[] =
+	"    </triangles>\n"
+	"   </mesh>\n"
+	"  </object>\n"
+	" </resources>\n"
+	" <build>\n"
+	"  <item objectid=\"1\"/>\n"
+	" </build>\n"
+	"</model>\n";
+
+std::string GetModelStart()
+{
+	char date[16] = {};
+	const std::time_t now = std::time(nullptr);
+	std::strftime(date, sizeof(date), "%Y-%m-%d", std::localtime(&now));
+
+	return "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	       "<model unit=\"millimeter\" xml:lang=\"en-US\" "
+	       "xmlns=\"http://schemas.microsoft.com/3dmanufacturing/core/2015/02\">\n"
+	       " <metadata name=\"Title\">Lithophane</metadata>\n"
+	       " <metadata name=\"Application\">LithoGen</metadata>\n"
+	       " <metadata name=\"CreationDate\">" + std::string(date) + "</metadata>\n"
+	       " <resources>\n"
+	       "  <object id=\"1\" type=\"model\">\n"
+	       "   <mesh>\n"
+	       "    <vertices>\n";
+}
+
+void EncodeVertices(const Model& model, const size_t begin, const size_t end, std::string& buffer)
+{
+	buffer.resize((end - begin) * THREEMF_ITEM_MAX_SIZE);
+
+	char* output = buffer.data();
+
+	for (size_t vertex = begin; vertex < end; vertex++) {
+		const glm::vec3& position = model.vertices[vertex].position;
+
+		output = AppendText(output, "     <vertex x=\"");
+		output = FormatFloat(output, position.x);
+		output = AppendText(output, "\" y=\"");
+		output = FormatFloat(output, position.y);
+		output = AppendText(output, "\" z=\"");
+		output = FormatFloat(output, position.z);
+		output = AppendText(output, "\"/>\n");
+	}
+
+	buffer.resize(output - buffer.data());
+}
+
+void EncodeTriangles(const Model& model, const size_t begin, const size_t end, std::string& buffer)
+{
+	buffer.resize((end - begin) * THREEMF_ITEM_MAX_SIZE);
+
+	char* output = buffer.data();
+
+	for (size_t triangle = begin; triangle < end; triangle++) {
+		const uint32_t* indices = model.indices.data() + triangle * 3;
+
+		output = AppendText(output, "     <triangle v1=\"");
+		output = FormatInteger(output, indices[0]);
+		output = AppendText(output, "\" v2=\"");
+		output = FormatInteger(output, indices[1]);
+		output = AppendText(output, "\" v3=\"");
+		output = FormatInteger(output, indices[2]);
+		output = AppendText(output, "\"/>\n");
+	}
+
+	buffer.resize(output - buffer.data());
+}
+
+bool WriteThreeMf(const char* filePath, const Model& model, ExportProgress& progress)
+{
+	const size_t triangleCount = model.indices.size() / 3;
+	progress.SetTotal(model.vertices.size() + triangleCount);
+
+	ZipWriter zip;
+
+	if (!zip.Open(filePath)) {
+		return false;
+	}
+
+	const auto write = [&zip](const char* data, const size_t size) {
+		return zip.Write(data, size);
+	};
+
+	const auto encodeVertices = [&model](const size_t begin, const size_t end, std::string& buffer) {
+		EncodeVertices(model, begin, end, buffer);
+	};
+
+	const auto encodeTriangles = [&model](const size_t begin, const size_t end, std::string& buffer) {
+		EncodeTriangles(model, begin, end, buffer);
+	};
+
+	const std::string modelStart = GetModelStart();
+	constexpr char verticesEnd[] = "    </vertices>\n    <triangles>\n";
+
+	// The model part only needs zip64 sizes if it could reach 4 GiB, judged by the longest every element could be.
+	const uint64_t maximumSize = modelStart.size() + (model.vertices.size() + triangleCount) * THREEMF_ITEM_MAX_SIZE +
+	                             sizeof(verticesEnd) + sizeof(THREEMF_MODEL_END);
+
+	const bool success =
+		zip.BeginEntry("[Content_Types].xml", false) &&
+		write(THREEMF_CONTENT_TYPES, sizeof(THREEMF_CONTENT_TYPES) - 1) && zip.EndEntry() &&
+		zip.BeginEntry("_rels/.rels", false) && write(THREEMF_RELATIONSHIPS, sizeof(THREEMF_RELATIONSHIPS) - 1) &&
+		zip.EndEntry() && zip.BeginEntry("3D/3dmodel.model", maximumSize >= 0xFFFFFFFF) &&
+		write(modelStart.data(), modelStart.size()) &&
+		EncodeBlocks(model.vertices.size(), THREEMF_ITEMS_PER_BLOCK, encodeVertices, write, progress) &&
+		write(verticesEnd, sizeof(verticesEnd) - 1) &&
+		EncodeBlocks(triangleCount, THREEMF_ITEMS_PER_BLOCK, encodeTriangles, write, progress) &&
+		write(THREEMF_MODEL_END, sizeof(THREEMF_MODEL_END) - 1) && zip.EndEntry();
+
+	return zip.Close() && success;
+}
\ No newline at end of file
@@ -0,0 +1,9 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include "../declarations/structures.h"
+#include "progress.h"
+
+// Write the model as an indexed 3MF package, which shares every vertex between its triangles and is deflated in
+// parallel, so it is far smaller than an STL of the same mesh.
+bool WriteThreeMf(const char* filePath, const Model& model, ExportProgress& progress);
\ No newline at end of file
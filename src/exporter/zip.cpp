@@ -0,0 +1,333 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "zip.h"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <thread>
+#include "../parallel.h"
+#include "deflate.h"
+
+// The input given to each deflate thread at a time.
+constexpr size_t ZIP_CHUNK_SIZE = 1 << 20;
+
+constexpr uint32_t ZIP_LOCAL_HEADER_SIGNATURE = 0x04034B50;
+constexpr uint32_t ZIP_CENTRAL_HEADER_SIGNATURE = 0x02014B50;
+constexpr uint32_t ZIP_END_SIGNATURE = 0x06054B50;
+constexpr uint32_t ZIP64_END_SIGNATURE = 0x06064B50;
+constexpr uint32_t ZIP64_LOCATOR_SIGNATURE = 0x07064B50;
+
+constexpr uint16_t ZIP_VERSION = 20;
+constexpr uint16_t ZIP64_VERSION = 45;
+constexpr uint16_t ZIP_FLAG_UTF8 = 0x0800;
+constexpr uint16_t ZIP_METHOD_STORE = 0;
+constexpr uint16_t ZIP_METHOD_DEFLATE = 8;
+constexpr uint16_t ZIP64_EXTRA_TAG = 0x0001;
+
+// The sizes of the fixed parts of a local header.
+constexpr size_t ZIP_LOCAL_HEADER_SIZE = 30;
+constexpr size_t ZIP64_LOCAL_EXTRA_SIZE = 20;
+
+// Little endian field writers for building headers.
+void PutU16(std::string& output, const uint16_t value)
+{
+	output.push_back(static_cast<char>(value & 0xFF));
+	output.push_back(static_cast<char>(value >> 8));
+}
+
+void PutU32(std::string& output, const uint32_t value)
+{
+	PutU16(output, static_cast<uint16_t>(value & 0xFFFF));
+	PutU16(output, static_cast<uint16_t>(value >> 16));
+}
+
+void PutU64(std::string& output, const uint64_t value)
+{
+	PutU32(output, static_cast<uint32_t>(value & 0xFFFFFFFF));
+	PutU32(output, static_cast<uint32_t>(value >> 32));
+}
+
+size_t GetBatchSize()
+{
+	return static_cast<size_t>(std::max(1U, std::thread::hardware_concurrency())) * ZIP_CHUNK_SIZE;
+}
+
+bool ZipWriter::Open(const char* filePath)
+{
+	m_offset = 0;
+	m_entries.clear();
+
+	// Every entry is stamped with the time the archive was written, in the MS-DOS format zip uses.
+	const std::time_t now = std::time(nullptr);
+	const std::tm* local = std::localtime(&now);
+
+	m_dosTime = static_cast<uint16_t>((local->tm_hour << 11) | (local->tm_min << 5) | (local->tm_sec / 2));
+	m_dosDate = static_cast<uint16_t>(((std::max(local->tm_year, 80) - 80) << 9) | ((local->tm_mon + 1) << 5) |
+	                                  local->tm_mday);
+
+	return m_file.Open(filePath);
+}
+
+bool ZipWriter::BeginEntry(const char* name, const bool large)
+{
+	EntryRecord entry;
+	entry.name = name;
+	entry.headerOffset = m_offset;
+	entry.method = ZIP_METHOD_DEFLATE;
+	entry.zip64 = large;
+
+	// The checksum and sizes are unknown until the entry ends, they are patched in then.
+	std::string header;
+	PutU32(header, ZIP_LOCAL_HEADER_SIGNATURE);
+	PutU16(header, large ? ZIP64_VERSION : ZIP_VERSION);
+	PutU16(header, ZIP_FLAG_UTF8);
+	PutU16(header, ZIP_METHOD_DEFLATE);
+	PutU16(header, m_dosTime);
+	PutU16(header, m_dosDate);
+	PutU32(header, 0);
+	PutU32(header, large ? 0xFFFFFFFF : 0);
+	PutU32(header, large ? 0xFFFFFFFF : 0);
+	PutU16(header, static_cast<uint16_t>(entry.name.size()));
+	PutU16(header, large ? ZIP64_LOCAL_EXTRA_SIZE : 0);
+	header += entry.name;
+
+	if (large) {
+		PutU16(header, ZIP64_EXTRA_TAG);
+		PutU16(header, 16);
+		PutU64(header, 0);
+		PutU64(header, 0);
+	}
+
+	m_entries.push_back(std::move(entry));
+	m_pending.clear();
+	m_historySize = 0;
+
+	return Append(header);
+}
+
+bool ZipWriter::Write(const void* data, const size_t size)
+{
+	const auto* bytes = static_cast<const unsigned char*>(data);
+	m_pending.insert(m_pending.end(), bytes, bytes + size);
+
+	// Hold back until every thread can be given a full chunk.
+	if (m_pending.size() - m_historySize >= GetBatchSize()) {
+		return CompressPending(false);
+	}
+
+	return true;
+}
+
+bool ZipWriter::EndEntry()
+{
+	if (!CompressPending(true)) {
+		return false;
+	}
+
+	const EntryRecord& entry = m_entries.back();
+
+	if (!entry.zip64 && (entry.size > 0xFFFFFFFF || entry.compressedSize > 0xFFFFFFFF)) {
+		return false; // The entry should have been marked as large.
+	}
+
+	std::string fields;
+	PutU32(fields, entry.crc);
+
+	if (entry.zip64) {
+		if (!m_file.WriteAt(fields.data(), fields.size(), entry.headerOffset + 14)) {
+			return false;
+		}
+
+		fields.clear();
+		PutU64(fields, entry.size);
+		PutU64(fields, entry.compressedSize);
+
+		return m_file.WriteAt(fields.data(), fields.size(),
+		                      entry.headerOffset + ZIP_LOCAL_HEADER_SIZE + entry.name.size() + 4);
+	}
+
+	PutU32(fields, static_cast<uint32_t>(entry.compressedSize));
+	PutU32(fields, static_cast<uint32_t>(entry.size));
+
+	return m_file.WriteAt(fields.data(), fields.size(), entry.headerOffset + 14);
+}
+
+bool ZipWriter::AddStoredEntry(const char* name, const void* data, const size_t size)
+{
+	const auto* bytes = static_cast<const unsigned char*>(data);
+
+	EntryRecord entry;
+	entry.name = name;
+	entry.headerOffset = m_offset;
+	entry.crc = Crc32(0, bytes, size);
+	entry.compressedSize = size;
+	entry.size = size;
+	entry.method = ZIP_METHOD_STORE;
+	entry.zip64 = size > 0xFFFFFFFF;
+
+	// Everything is known upfront, so the header is written complete.
+	std::string header;
+	PutU32(header, ZIP_LOCAL_HEADER_SIGNATURE);
+	PutU16(header, entry.zip64 ? ZIP64_VERSION : ZIP_VERSION);
+	PutU16(header, ZIP_FLAG_UTF8);
+	PutU16(header, ZIP_METHOD_STORE);
+	PutU16(header, m_dosTime);
+	PutU16(header, m_dosDate);
+	PutU32(header, entry.crc);
+	PutU32(header, entry.zip64 ? 0xFFFFFFFF : static_cast<uint32_t>(size));
+	PutU32(header, entry.zip64 ? 0xFFFFFFFF : static_cast<uint32_t>(size));
+	PutU16(header, static_cast<uint16_t>(entry.name.size()));
+	PutU16(header, entry.zip64 ? ZIP64_LOCAL_EXTRA_SIZE : 0);
+	header += entry.name;
+
+	if (entry.zip64) {
+		PutU16(header, ZIP64_EXTRA_TAG);
+		PutU16(header, 16);
+		PutU64(header, size);
+		PutU64(header, size);
+	}
+
+	m_entries.push_back(std::move(entry));
+
+	if (!Append(header) || !m_file.WriteAt(data, size, m_offset)) {
+		return false;
+	}
+
+	m_offset += size;
+
+	return true;
+}
+
+bool ZipWriter::Close()
+{
+	const uint64_t directoryOffset = m_offset;
+	bool zip64 = m_entries.size() >= 0xFFFF;
+
+	std::string directory;
+
+	for (const EntryRecord& entry : m_entries) {
+		// Once any field overflows all three are moved into the zip64 extra field.
+		const bool entryZip64 = entry.zip64 || entry.headerOffset >= 0xFFFFFFFF;
+		zip64 = zip64 || entryZip64;
+
+		PutU32(directory, ZIP_CENTRAL_HEADER_SIGNATURE);
+		PutU16(directory, entryZip64 ? ZIP64_VERSION : ZIP_VERSION);
+		PutU16(directory, entryZip64 ? ZIP64_VERSION : ZIP_VERSION);
+		PutU16(directory, ZIP_FLAG_UTF8);
+		PutU16(directory, entry.method);
+		PutU16(directory, m_dosTime);
+		PutU16(directory, m_dosDate);
+		PutU32(directory, entry.crc);
+		PutU32(directory, entryZip64 ? 0xFFFFFFFF : static_cast<uint32_t>(entry.compressedSize));
+		PutU32(directory, entryZip64 ? 0xFFFFFFFF : static_cast<uint32_t>(entry.size));
+		PutU16(directory, static_cast<uint16_t>(entry.name.size()));
+		PutU16(directory, entryZip64 ? 28 : 0);
+		PutU16(directory, 0); // Comment length.
+		PutU16(directory, 0); // Disk number.
+		PutU16(directory, 0); // Internal attributes.
+		PutU32(directory, 0); // External attributes.
+		PutU32(directory, entryZip64 ? 0xFFFFFFFF : static_cast<uint32_t>(entry.headerOffset));
+		directory += entry.name;
+
+		if (entryZip64) {
+			PutU16(directory, ZIP64_EXTRA_TAG);
+			PutU16(directory, 24);
+			PutU64(directory, entry.size);
+			PutU64(directory, entry.compressedSize);
+			PutU64(directory, entry.headerOffset);
+		}
+	}
+
+	const uint64_t directorySize = directory.size();
+	zip64 = zip64 || directoryOffset >= 0xFFFFFFFF || directorySize >= 0xFFFFFFFF;
+
+	std::string end;
+
+	if (zip64) {
+		const uint64_t zip64EndOffset = directoryOffset + directorySize;
+
+		PutU32(end, ZIP64_END_SIGNATURE);
+		PutU64(end, 44); // The size of the rest of this record.
+		PutU16(end, ZIP64_VERSION);
+		PutU16(end, ZIP64_VERSION);
+		PutU32(end, 0);
+		PutU32(end, 0);
+		PutU64(end, m_entries.size());
+		PutU64(end, m_entries.size());
+		PutU64(end, directorySize);
+		PutU64(end, directoryOffset);
+
+		PutU32(end, ZIP64_LOCATOR_SIGNATURE);
+		PutU32(end, 0);
+		PutU64(end, zip64EndOffset);
+		PutU32(end, 1);
+	}
+
+	PutU32(end, ZIP_END_SIGNATURE);
+	PutU16(end, 0);
+	PutU16(end, 0);
+	PutU16(end, zip64 ? 0xFFFF : static_cast<uint16_t>(m_entries.size()));
+	PutU16(end, zip64 ? 0xFFFF : static_cast<uint16_t>(m_entries.size()));
+	PutU32(end, zip64 ? 0xFFFFFFFF : static_cast<uint32_t>(directorySize));
+	PutU32(end, zip64 ? 0xFFFFFFFF : static_cast<uint32_t>(directoryOffset));
+	PutU16(end, 0); // Comment length.
+
+	const bool success = Append(directory) && Append(end);
+
+	return m_file.Close() && success;
+}
+
+bool ZipWriter::CompressPending(const bool final)
+{
+	EntryRecord& entry = m_entries.back();
+
+	const unsigned char* input = m_pending.data() + m_historySize;
+	const size_t inputSize = m_pending.size() - m_historySize;
+
+	// The final call always produces at least one chunk, even if empty, to end the deflate stream.
+	const size_t chunkCount = std::max<size_t>(final ? 1 : 0, (inputSize + ZIP_CHUNK_SIZE - 1) / ZIP_CHUNK_SIZE);
+
+	std::vector<std::string> outputs(chunkCount);
+	std::vector<uint32_t> checksums(chunkCount);
+
+	ParallelFor(chunkCount, [&](const size_t begin, const size_t end) {
+		for (size_t chunk = begin; chunk < end; chunk++) {
+			const size_t offset = chunk * ZIP_CHUNK_SIZE;
+			const size_t size = std::min(ZIP_CHUNK_SIZE, inputSize - offset);
+
+			// Each chunk can match into the data before it, which is the previous chunk or the retained history.
+			DeflateChunk(input + offset, size, m_historySize + offset, final && chunk == chunkCount - 1,
+			             outputs[chunk]);
+			checksums[chunk] = Crc32(0, input + offset, size);
+		}
+	});
+
+	for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+		const size_t size = std::min(ZIP_CHUNK_SIZE, inputSize - chunk * ZIP_CHUNK_SIZE);
+
+		entry.crc = Crc32Combine(entry.crc, checksums[chunk], size);
+		entry.size += size;
+		entry.compressedSize += outputs[chunk].size();
+
+		if (!Append(outputs[chunk])) {
+			return false;
+		}
+	}
+
+	// Keep the tail of the data as history for the chunks that follow.
+	const size_t keep = std::min(DEFLATE_WINDOW_SIZE, m_pending.size());
+	m_pending.erase(m_pending.begin(), m_pending.end() - static_cast<std::ptrdiff_t>(keep));
+	m_historySize = keep;
+
+	return true;
+}
+
+bool ZipWriter::Append(const std::string& bytes)
+{
+	if (!m_file.WriteAt(bytes.data(), bytes.size(), m_offset)) {
+		return false;
+	}
+
+	m_offset += bytes.size();
+
+	return true;
+}
\ No newline at end of file
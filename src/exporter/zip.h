@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "file.h"
+
+// Writes a zip archive, streaming each entry through the parallel deflate encoder. Entry data is buffered until a batch
+// of chunks is ready, every chunk of the batch is then compressed and checksummed on its own thread and the results
+// are written in order, so memory stays bounded however large an entry grows.
+class ZipWriter {
+public:
+	ZipWriter() = default;
+
+	bool Open(const char* filePath);
+	// Start a new entry, entries which may exceed 4 GiB must be marked as large so their sizes are stored as zip64.
+	bool BeginEntry(const char* name, bool large);
+	bool Write(const void* data, size_t size);
+	bool EndEntry();
+	// Add a whole entry without compressing it, for data which is already compressed.
+	bool AddStoredEntry(const char* name, const void* data, size_t size);
+	// Write the central directory and close the file.
+	bool Close();
+private:
+	struct EntryRecord {
+		std::string name;
+		uint64_t headerOffset = 0;
+		uint32_t crc = 0;
+		uint64_t compressedSize = 0;
+		uint64_t size = 0;
+		uint16_t method = 0;
+		bool zip64 = false;
+	};
+
+	bool CompressPending(bool final);
+	bool Append(const std::string& bytes);
+
+	OutputFile m_file;
+	uint64_t m_offset = 0;
+	uint16_t m_dosTime = 0;
+	uint16_t m_dosDate = 0;
+
+	std::vector<EntryRecord> m_entries;
+
+	// The data of the current entry waiting to be compressed, preceded by the history the next chunk may refer to.
+	std::vector<unsigned char> m_pending;
+	size_t m_historySize = 0;
+};
\ No newline at end of file
@@ -0,0 +1,244 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "exporting.h"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <iostream>
+#include "exporter/file.h"
+#include "exporter/gcode.h"
+#include "exporter/gltf.h"
+#include "exporter/native.h"
+#include "exporter/obj.h"
+#include "exporter/ply.h"
+#include "exporter/slices.h"
+#include "exporter/stl.h"
+#include "exporter/threemf.h"
+#include "meshcache.h"
+#include "storage.h"
+#include "vertexorder.h"
+
+std::string GetExportExtension(const char* filePath)
+{
+	std::string extension = std::filesystem::path(filePath).extension().string();
+	std::ranges::transform(extension, extension.begin(), [](const unsigned char c) { return std::tolower(c); });
+
+	if (extension == ".3mf" || extension == ".ply" || extension == ".obj" || extension == ".glb" ||
+	    extension == ".lgm" || extension == ".gcode") {
+		return extension;
+	}
+
+	return ".stl";
+}
+
+bool IsVertexOrderExport(const char* filePath)
+{
+	const std::string extension = GetExportExtension(filePath);
+
+	return extension == ".ply" || extension == ".obj" || extension == ".glb";
+}
+
+// Read the printer profile from the configuration directory. The defaults are written there when it is missing, so
+// there is a file for the user to edit. Fails with the reason if the file holds a value that can not be read.
+bool GetPrinterProfile(PrinterProfile& profile, std::string& error)
+{
+	const std::filesystem::path directory = GetConfigDirectory();
+
+	if (directory.empty()) {
+		return true;
+	}
+
+	const std::filesystem::path path = directory / "printer.ini";
+
+	if (LoadPrinterProfile(path, profile, error)) {
+		std::cout << "Using printer profile \"" << path.string() << "\".\n";
+	} else if (!error.empty()) {
+		error += "\nCorrect it in \"" + path.string() + "\".";
+		return false;
+	} else if (SavePrinterProfile(path, profile)) {
+		std::cout << "Written default printer profile to \"" << path.string() << "\".\n";
+	}
+
+	return true;
+}
+
+// In the same directory as the destination, as a rename is only atomic within one file system.
+std::string GetTemporaryPath(const std::string& filePath)
+{
+	const size_t separator = filePath.find_last_of("/\\");
+	const size_t nameStart = separator == std::string::npos ? 0 : separator + 1;
+
+	return filePath.substr(0, nameStart) + "." + filePath.substr(nameStart) + ".partial";
+}
+
+// Move a finished export over the destination, or remove it if writing it failed or was cancelled.
+bool FinishExport(const std::string& temporaryPath, const char* filePath, const bool success, const std::string& format,
+                  const char* content, const ExportProgress& progress, std::string& error)
+{
+	if (progress.IsCancelled()) {
+		RemoveFile(temporaryPath.c_str());
+		std::cout << "Export cancelled.\n";
+		return false;
+	}
+
+	if (!success) {
+		RemoveFile(temporaryPath.c_str());
+
+		// A writer that knows why it failed has already given the reason.
+		if (error.empty()) {
+			error = "Failed to write the " + format + " file \"" + filePath + "\".";
+		}
+
+		std::cerr << error << '\n';
+		return false;
+	}
+
+	if (!RenameFile(temporaryPath.c_str(), filePath)) {
+		RemoveFile(temporaryPath.c_str());
+		error = "Failed to replace \"" + std::string(filePath) + "\" with the exported file.";
+		std::cerr << error << '\n';
+		return false;
+	}
+
+	std::cout << "Written " << content << " to disk as \"" << filePath << "\".\n";
+	std::flush(std::cout);
+
+	return true;
+}
+
+bool WriteModel(const char* filePath, const Model& model, const bool ascii, const bool optimize,
+                ExportProgress& progress, std::string& error)
+{
+	// The compiled layout is kept, so the optimised order is written from a copy.
+	if (optimize && IsVertexOrderExport(filePath)) {
+		Model optimized = model;
+		OptimizeModel(optimized);
+
+		return WriteModel(filePath, optimized, ascii, false, progress, error);
+	}
+
+	// The format follows the extension the file was given.
+	const std::string extension = GetExportExtension(filePath);
+
+	const std::string temporaryPath = GetTemporaryPath(filePath);
+	bool success;
+
+	if (extension == ".3mf") {
+		success = WriteThreeMf(temporaryPath.c_str(), model, progress);
+	} else if (extension == ".ply") {
+		success = WritePly(temporaryPath.c_str(), model, progress);
+	} else if (extension == ".obj") {
+		success = WriteObj(temporaryPath.c_str(), model, progress);
+	} else if (extension == ".glb") {
+		success = WriteGlb(temporaryPath.c_str(), model, progress);
+	} else if (extension == ".lgm") {
+		success = WriteMeshFile(temporaryPath.c_str(), model, progress);
+	} else if (extension == ".gcode") {
+		PrinterProfile profile;
+		success = GetPrinterProfile(profile, error) &&
+		          WriteGcode(temporaryPath.c_str(), model, profile, progress, error);
+	} else {
+		success = ascii ? WriteAsciiStl(temporaryPath.c_str(), model, progress)
+		                : WriteBinaryStl(temporaryPath.c_str(), model, progress);
+	}
+
+	return FinishExport(temporaryPath, filePath, success, extension.substr(1), "mesh", progress, error);
+}
+
+bool WriteSlices(const char* filePath, const std::vector<float>& depthMap, const int width, const int height,
+                 const Config* config, ExportProgress& progress, std::string& error)
+{
+	const std::string temporaryPath = GetTemporaryPath(filePath);
+	const bool success = WriteLayerSlices(temporaryPath.c_str(), depthMap, width, height, config, progress);
+
+	return FinishExport(temporaryPath, filePath, success, "slice archive", "layer slices", progress, error);
+}
+
+ModelExporter::ModelExporter(MeshCache* meshCache) : m_meshCache(meshCache) {}
+
+ModelExporter::~ModelExporter()
+{
+	Cancel();
+}
+
+void ModelExporter::Start(const char* filePath, const Model& model, const bool ascii, const bool optimize)
+{
+	if (IsBusy()) {
+		return;
+	}
+
+	Run([meshCache = m_meshCache, &model, ascii, optimize, path = std::string(filePath)](ExportProgress& progress,
+	                                                                                     std::string& error) {
+		if (meshCache->LoadExport(model.settings, path.c_str(), ascii, optimize)) {
+			return true;
+		}
+
+		if (!WriteModel(path.c_str(), model, ascii, optimize, progress, error)) {
+			return false;
+		}
+
+		meshCache->StoreExport(model.settings, path.c_str(), ascii, optimize);
+
+		return true;
+	});
+}
+
+void ModelExporter::StartSlices(const char* filePath, std::shared_ptr<const std::vector<float>> depthMap,
+                                const int width, const int height, const Config& config)
+{
+	if (IsBusy()) {
+		return;
+	}
+
+	Run([depthMap = std::move(depthMap), width, height, config, path = std::string(filePath)](ExportProgress& progress,
+	                                                                                         std::string& error) {
+		return WriteSlices(path.c_str(), *depthMap, width, height, &config, progress, error);
+	});
+}
+
+void ModelExporter::Run(std::function<bool(ExportProgress&, std::string&)> task)
+{
+	auto job = std::make_shared<Job>();
+	m_job = job;
+
+	// The previous worker has already finished, assigning the new one joins it.
+	m_thread = std::jthread([job, task = std::move(task)] {
+		std::string error;
+		const bool success = task(job->progress, error);
+
+		job->success = success;
+		job->error = std::move(error);
+		job->finished = true;
+	});
+}
+
+void ModelExporter::Cancel()
+{
+	if (m_job != nullptr) {
+		m_job->progress.Cancel();
+	}
+}
+
+bool ModelExporter::PollResult(bool& success, std::string& error)
+{
+	if (m_job == nullptr || !m_job->finished) {
+		return false;
+	}
+
+	success = m_job->success;
+	error = std::move(m_job->error);
+
+	// The worker has finished with the job and the model, so both can be let go.
+	m_job = nullptr;
+
+	return true;
+}
+
+float ModelExporter::GetProgress() const
+{
+	return m_job == nullptr ? 0.0F : m_job->progress.GetFraction();
+}
+
+bool ModelExporter::IsBusy() const
+{
+	return m_job != nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "declarations/config.h"
+#include "declarations/structures.h"
+#include "exporter/progress.h"
+
+class MeshCache;
+
+// The lowercase extension of the format a path is exported as, anything unrecognised is exported as an STL.
+std::string GetExportExtension(const char* filePath);
+// A hidden file in the same directory as the path, for writing to before it is renamed into place.
+std::string GetTemporaryPath(const std::string& filePath);
+
+// Whether the vertex order of a format can be optimised, only indexed formats mostly read by renderers are. Mesh files
+// and G-code rely on the grid layout of a compiled mesh.
+bool IsVertexOrderExport(const char* filePath);
+
+// Write the model in the format named by the extension of the path, ascii selects the STL encoding and optimize
+// reorders a copy of the model for the vertex cache where the format allows it. The file is written beside the
+// destination and only moved over it once complete and flushed, so the destination never holds a partial file. On
+// failure the error describes what went wrong.
+bool WriteModel(const char* filePath, const Model& model, bool ascii, bool optimize, ExportProgress& progress,
+                std::string& error);
+
+// Slice the height field of a depth map into a resin printer layer archive, written like WriteModel.
+bool WriteSlices(const char* filePath, const std::vector<float>& depthMap, int width, int height, const Config* config,
+                 ExportProgress& progress, std::string& error);
+
+// Exports the model on a background thread so the interface keeps running while large files are written. The model is
+// read in place rather than copied, so it must not change until the export has finished. A previous export of the same
+// mesh to the same format is copied from the cache instead of being written again.
+class ModelExporter {
+public:
+	explicit ModelExporter(MeshCache* meshCache);
+	// An export in flight is cancelled and waited for, so its partial file is always removed.
+	~ModelExporter();
+
+	ModelExporter(const ModelExporter&) = delete;
+	ModelExporter& operator=(const ModelExporter&) = delete;
+
+	// Start writing the model, unless an export is already in progress.
+	void Start(const char* filePath, const Model& model, bool ascii, bool optimize);
+	// Start slicing a depth map of the given size, which is shared so it stays alive until the export has finished.
+	void StartSlices(const char* filePath, std::shared_ptr<const std::vector<float>> depthMap, int width, int height,
+	                 const Config& config);
+	void Cancel();
+
+	// Collect the outcome of the finished export, this only succeeds once per export. A cancelled export is not a
+	// success, but has no error.
+	bool PollResult(bool& success, std::string& error);
+
+	[[nodiscard]] float GetProgress() const;
+	[[nodiscard]] bool IsBusy() const;
+private:
+	// The state shared between the main thread and the worker.
+	struct Job {
+		ExportProgress progress;
+		std::atomic<bool> finished = false;
+
+		bool success = false;
+		std::string error;
+	};
+
+	// Run the task on the worker thread, it reports success and fills in the error on failure.
+	void Run(std::function<bool(ExportProgress&, std::string&)> task);
+
+	MeshCache* m_meshCache = nullptr;
+	std::shared_ptr<Job> m_job;
+	std::jthread m_thread;
+};
\ No newline at end of file
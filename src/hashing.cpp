@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "hashing.h"
+#include <bit>
+#include <cstring>
+#include <vector>
+#include "parallel.h"
+
+constexpr uint64_t HASH_MULTIPLIER_A = 0x9E3779B97F4A7C15ULL;
+constexpr uint64_t HASH_MULTIPLIER_B = 0xC2B2AE3D27D4EB4FULL;
+
+// The final avalanche of MurmurHash3, so every input bit affects every output bit.
+uint64_t MixHash(uint64_t hash)
+{
+	hash ^= hash >> 33;
+	hash *= 0xFF51AFD7ED558CCDULL;
+	hash ^= hash >> 33;
+	hash *= 0xC4CEB9FE1A85EC53ULL;
+	hash ^= hash >> 33;
+
+	return hash;
+}
+
+uint64_t HashBytes(const void* data, const size_t size, const uint64_t seed)
+{
+	const auto* bytes = static_cast<const unsigned char*>(data);
+	uint64_t hash = seed ^ (size * HASH_MULTIPLIER_B);
+	size_t offset = 0;
+
+	// A word at a time, the tail is padded with zeroes.
+	for (; offset + 8 <= size; offset += 8) {
+		uint64_t word = 0;
+		memcpy(&word, bytes + offset, 8);
+		hash = std::rotl(hash ^ (word * HASH_MULTIPLIER_A), 31) * HASH_MULTIPLIER_B;
+	}
+
+	if (offset < size) {
+		uint64_t word = 0;
+		memcpy(&word, bytes + offset, size - offset);
+		hash = std::rotl(hash ^ (word * HASH_MULTIPLIER_A), 31) * HASH_MULTIPLIER_B;
+	}
+
+	return MixHash(hash);
+}
+
+uint64_t CombineHash(const uint64_t hash, const uint64_t value)
+{
+	return MixHash(std::rotl(hash, 27) ^ (value * HASH_MULTIPLIER_A));
+}
+
+uint64_t HashImageView(const ImageView& view)
+{
+	if (view.data == nullptr || view.width <= 0 || view.height <= 0) {
+		return 0;
+	}
+
+	std::vector<uint64_t> rowHashes(view.height);
+	const size_t rowSize = static_cast<size_t>(view.width) * 4;
+
+	ParallelFor(
+		rowHashes.size(),
+		[&](const size_t begin, const size_t end) {
+			for (size_t row = begin; row < end; row++) {
+				rowHashes[row] = HashBytes(view.GetPixel(0, static_cast<int>(row)), rowSize);
+			}
+		},
+		64);
+
+	uint64_t hash = CombineHash(static_cast<uint64_t>(view.width), static_cast<uint64_t>(view.height));
+
+	for (const uint64_t rowHash : rowHashes) {
+		hash = CombineHash(hash, rowHash);
+	}
+
+	return hash;
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "declarations/structures.h"
+
+// A fast 64-bit hash for identifying content, such as cache keys. It is not cryptographic and must not be relied on to
+// resist deliberate collisions.
+uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0);
+// Mix a value into a running hash, order matters.
+uint64_t CombineHash(uint64_t hash, uint64_t value);
+
+// Hash the pixels inside a view, ignoring anything outside it. Rows are hashed in parallel then combined in order.
+uint64_t HashImageView(const ImageView& view);
\ No newline at end of file
@@ -0,0 +1,376 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "imagecache.h"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include "compilation.h"
+#include "importing.h"
+#include "mapping.h"
+
+// The header written before every spilled plane.
+struct SpillHeader {
+	char magic[4] = {'L', 'G', 'I', 'C'};
+	uint32_t isDepth = 0;
+	int32_t width = 0;
+	int32_t height = 0;
+	uint64_t keyLength = 0;
+};
+
+bool BuildImageKey(const char* filePath, std::string& key)
+{
+	std::error_code error;
+	const std::filesystem::path path =
+		std::filesystem::absolute(std::filesystem::path(reinterpret_cast<const char8_t*>(filePath)), error);
+
+	if (error || !std::filesystem::is_regular_file(path, error)) {
+		return false;
+	}
+
+	const uintmax_t size = std::filesystem::file_size(path, error);
+
+	if (error) {
+		return false;
+	}
+
+	const auto modified = std::filesystem::last_write_time(path, error);
+
+	if (error) {
+		return false;
+	}
+
+	// All images are currently decoded into 8-bit RGBA.
+	key = path.string() + '|' + std::to_string(size) + '|' + std::to_string(modified.time_since_epoch().count()) +
+	      "|rgba8";
+
+	return true;
+}
+
+// FNV-1a, only used to derive spill file names, the full key is stored in the file to resolve collisions.
+uint64_t HashKey(const std::string& key)
+{
+	uint64_t hash = 14695981039346656037ULL;
+
+	for (const char character : key) {
+		hash ^= static_cast<unsigned char>(character);
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+ImageCache::ImageCache(const size_t memoryCap) : m_memoryCap(memoryCap) {}
+
+bool ImageCache::LoadImage(const char* filePath, Image& image, const HeaderCallback& onHeader)
+{
+	std::string key;
+
+	// Streams and anything else without a stable identity bypass the cache.
+	if (!BuildImageKey(filePath, key)) {
+		return LoadImageFile(filePath, image, onHeader);
+	}
+
+	if (Entry cached; Lookup(key, cached)) {
+		if (onHeader != nullptr && !onHeader(cached.width, cached.height)) {
+			return false;
+		}
+
+		image.width = cached.width;
+		image.height = cached.height;
+		image.pixels = cached.pixels;
+		image.data = image.pixels.get();
+		image.sourceKey = key;
+
+		std::cout << "Loaded image from cache.\n";
+		return true;
+	}
+
+	// Decode outside of the lock so other threads can keep using the cache in the meantime.
+	if (!LoadImageFile(filePath, image, onHeader)) {
+		return false;
+	}
+
+	image.sourceKey = key;
+
+	Entry decoded;
+	decoded.key = key;
+	decoded.width = image.width;
+	decoded.height = image.height;
+	decoded.pixels = image.pixels;
+	decoded.bytes = static_cast<size_t>(image.width) * image.height * 4;
+
+	Store(std::move(decoded));
+
+	return true;
+}
+
+std::string BuildDepthKey(const Image& image, const ImageView& view, const Config* config)
+{
+	// Every setting that changes the per pixel depth must be part of the key, including the region being read.
+	std::string key = image.sourceKey + "|depth|" + std::to_string(view.x) + ',' + std::to_string(view.y) + ',' +
+	                  std::to_string(view.width) + ',' + std::to_string(view.height);
+
+	// Weights are keyed by their bits, as printing them would round apart values to the same text.
+	for (const float preference : config->sliderGsPref) {
+		key += '|' + std::to_string(std::bit_cast<uint32_t>(preference));
+	}
+
+	return key;
+}
+
+std::shared_ptr<const std::vector<float>> ImageCache::GetDepthMap(const Image& image, const ImageView& view,
+                                                                  const Config* config)
+{
+	const std::string key = BuildDepthKey(image, view, config);
+
+	if (Entry cached; !image.sourceKey.empty() && Lookup(key, cached)) {
+		return cached.depthMap;
+	}
+
+	auto depthMap = std::make_shared<std::vector<float>>();
+	ComputeDepthMap(*depthMap, config, view);
+
+	if (!image.sourceKey.empty()) {
+		Entry computed;
+		computed.key = key;
+		computed.width = view.width;
+		computed.height = view.height;
+		computed.depthMap = depthMap;
+		computed.bytes = depthMap->size() * sizeof(float);
+
+		Store(std::move(computed));
+	}
+
+	return depthMap;
+}
+
+void ImageCache::SetSpillDirectory(const std::filesystem::path& directory)
+{
+	std::lock_guard lock(m_mutex);
+
+	m_spillDirectory = directory;
+
+	if (!m_spillDirectory.empty()) {
+		std::error_code error;
+		std::filesystem::create_directories(m_spillDirectory, error);
+	}
+}
+
+size_t ImageCache::GetMemoryUsage() const
+{
+	std::lock_guard lock(m_mutex);
+
+	return m_memoryUsage;
+}
+
+bool ImageCache::Lookup(const std::string& key, Entry& entry)
+{
+	std::lock_guard lock(m_mutex);
+
+	if (const Entry* found = Find(key); found != nullptr) {
+		entry = *found;
+		return true;
+	}
+
+	if (!Restore(key, entry)) {
+		return false;
+	}
+
+	Insert(entry);
+
+	return true;
+}
+
+void ImageCache::Store(Entry entry)
+{
+	std::lock_guard lock(m_mutex);
+
+	// Another thread may have stored the same entry while this one was decoding.
+	if (Find(entry.key) != nullptr) {
+		return;
+	}
+
+	Insert(std::move(entry));
+}
+
+ImageCache::Entry* ImageCache::Find(const std::string& key)
+{
+	const auto found = m_lookup.find(key);
+
+	if (found == m_lookup.end()) {
+		return nullptr;
+	}
+
+	// Move the entry to the front as it is now the most recently used.
+	m_entries.splice(m_entries.begin(), m_entries, found->second);
+
+	return &*found->second;
+}
+
+void ImageCache::Insert(Entry entry)
+{
+	// An entry larger than the whole cache would only evict everything else and then itself.
+	if (entry.bytes > m_memoryCap) {
+		return;
+	}
+
+	m_memoryUsage += entry.bytes;
+	m_entries.push_front(std::move(entry));
+	m_lookup[m_entries.front().key] = m_entries.begin();
+
+	Evict();
+}
+
+void ImageCache::Evict()
+{
+	while (m_memoryUsage > m_memoryCap && !m_entries.empty()) {
+		const Entry& last = m_entries.back();
+
+		if (!m_spillDirectory.empty()) {
+			Spill(last);
+		}
+
+		m_memoryUsage -= last.bytes;
+		m_lookup.erase(last.key);
+		m_entries.pop_back();
+	}
+}
+
+void ImageCache::Spill(const Entry& entry) const
+{
+	const std::filesystem::path path = GetSpillPath(entry.key);
+
+	// Planes are immutable for a given key, so an existing spill is already up to date.
+	if (std::error_code error; std::filesystem::exists(path, error)) {
+		return;
+	}
+
+	SpillHeader header;
+	header.isDepth = entry.depthMap != nullptr ? 1 : 0;
+	header.width = entry.width;
+	header.height = entry.height;
+	header.keyLength = entry.key.size();
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(SpillHeader));
+	file.write(entry.key.data(), static_cast<std::streamsize>(entry.key.size()));
+
+	if (entry.depthMap != nullptr) {
+		file.write(reinterpret_cast<const char*>(entry.depthMap->data()),
+		           static_cast<std::streamsize>(entry.depthMap->size() * sizeof(float)));
+	} else {
+		file.write(reinterpret_cast<const char*>(entry.pixels.get()), static_cast<std::streamsize>(entry.bytes));
+	}
+
+	if (!file) {
+		std::cout << "Failed to spill image cache entry to disk!\n";
+		file.close();
+
+		std::error_code error;
+		std::filesystem::remove(path, error);
+		return;
+	}
+
+	file.close();
+	TrimSpillDirectory();
+}
+
+bool ImageCache::Restore(const std::string& key, Entry& entry) const
+{
+	if (m_spillDirectory.empty()) {
+		return false;
+	}
+
+	const std::filesystem::path path = GetSpillPath(key);
+
+	if (std::error_code error; !std::filesystem::exists(path, error)) {
+		return false;
+	}
+
+	MappedFile file;
+
+	if (!file.Open(path.string().c_str()) || file.GetSize() < sizeof(SpillHeader)) {
+		return false;
+	}
+
+	SpillHeader header;
+	memcpy(&header, file.GetData(), sizeof(SpillHeader));
+
+	const size_t pixelCount = static_cast<size_t>(header.width) * header.height;
+	const size_t planeBytes = pixelCount * (header.isDepth != 0 ? sizeof(float) : 4);
+	const size_t planeOffset = sizeof(SpillHeader) + header.keyLength;
+
+	// Reject foreign files, hash collisions and truncated spills.
+	if (memcmp(header.magic, SpillHeader().magic, 4) != 0 || header.keyLength != key.size() ||
+	    file.GetSize() != planeOffset + planeBytes ||
+	    memcmp(file.GetData() + sizeof(SpillHeader), key.data(), key.size()) != 0) {
+		return false;
+	}
+
+	const unsigned char* plane = file.GetData() + planeOffset;
+
+	entry.key = key;
+	entry.width = header.width;
+	entry.height = header.height;
+	entry.bytes = planeBytes;
+
+	if (header.isDepth != 0) {
+		auto depthMap = std::make_shared<std::vector<float>>(pixelCount);
+		memcpy(depthMap->data(), plane, planeBytes);
+		entry.depthMap = std::move(depthMap);
+	} else {
+		auto* pixels = new stbi_uc[planeBytes];
+		memcpy(pixels, plane, planeBytes);
+		entry.pixels = std::shared_ptr<stbi_uc>(pixels, std::default_delete<stbi_uc[]>());
+	}
+
+	return true;
+}
+
+void ImageCache::TrimSpillDirectory() const
+{
+	// Allow the spill to grow to a multiple of the memory cap before the oldest planes are removed.
+	const uintmax_t diskCap = static_cast<uintmax_t>(m_memoryCap) * 4;
+
+	struct SpillFile {
+		std::filesystem::path path;
+		std::filesystem::file_time_type modified;
+		uintmax_t size;
+	};
+
+	std::vector<SpillFile> files;
+	uintmax_t totalSize = 0;
+	std::error_code error;
+
+	for (const auto& item : std::filesystem::directory_iterator(m_spillDirectory, error)) {
+		if (!item.is_regular_file(error) || item.path().extension() != ".plane") {
+			continue;
+		}
+
+		files.push_back({item.path(), item.last_write_time(error), item.file_size(error)});
+		totalSize += files.back().size;
+	}
+
+	std::ranges::sort(files, {}, &SpillFile::modified);
+
+	for (const SpillFile& file : files) {
+		if (totalSize <= diskCap) {
+			break;
+		}
+
+		std::filesystem::remove(file.path, error);
+		totalSize -= file.size;
+	}
+}
+
+std::filesystem::path ImageCache::GetSpillPath(const std::string& key) const
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.plane", static_cast<unsigned long long>(HashKey(key)));
+
+	return m_spillDirectory / name;
+}
\ No newline at end of file
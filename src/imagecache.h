@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "declarations/config.h"
+#include "declarations/structures.h"
+#include "importing.h"
+
+// Build the identity of a file on disk together with the parameters used to decode it, which changes whenever the file
+// does. Fails for anything that is not a regular file.
+bool BuildImageKey(const char* filePath, std::string& key);
+
+// Build the identity of the depth map of a view into an image, covering every setting that changes the depth of a
+// pixel including the region being read.
+std::string BuildDepthKey(const Image& image, const ImageView& view, const Config* config);
+
+// An in-process least recently used cache of decoded images and the depth maps derived from them. Images are keyed by
+// their path, size, modification time and decode parameters so an edited file is never served stale. Entries pushed
+// out by the memory cap can optionally be spilled to disk as raw planes, which are far cheaper to read than decoding.
+// All public functions are safe to call from multiple threads.
+class ImageCache {
+public:
+	explicit ImageCache(size_t memoryCap);
+
+	// Load an image through the cache, only decoding it if it is neither held in memory nor spilled to disk.
+	bool LoadImage(const char* filePath, Image& image, const HeaderCallback& onHeader = nullptr);
+	// The depth map of a view into an image under the current configuration, it is computed and stored on a miss.
+	std::shared_ptr<const std::vector<float>> GetDepthMap(const Image& image, const ImageView& view,
+	                                                      const Config* config);
+
+	// Set the directory evicted entries are spilled to, an empty path disables spilling.
+	void SetSpillDirectory(const std::filesystem::path& directory);
+
+	[[nodiscard]] size_t GetMemoryUsage() const;
+private:
+	struct Entry {
+		std::string key;
+		int width = 0;
+		int height = 0;
+		std::shared_ptr<stbi_uc> pixels;
+		std::shared_ptr<const std::vector<float>> depthMap;
+		size_t bytes = 0;
+	};
+
+	// Thread safe wrappers, looking up an entry in memory or on disk and storing a newly created entry.
+	bool Lookup(const std::string& key, Entry& entry);
+	void Store(Entry entry);
+
+	// These expect the mutex to already be held.
+	Entry* Find(const std::string& key);
+	void Insert(Entry entry);
+	void Evict();
+
+	void Spill(const Entry& entry) const;
+	bool Restore(const std::string& key, Entry& entry) const;
+	void TrimSpillDirectory() const;
+	[[nodiscard]] std::filesystem::path GetSpillPath(const std::string& key) const;
+
+	std::list<Entry> m_entries; // Ordered from most to least recently used.
+	std::unordered_map<std::string, std::list<Entry>::iterator> m_lookup;
+	std::filesystem::path m_spillDirectory;
+	mutable std::mutex m_mutex;
+
+	size_t m_memoryCap = 0;
+	size_t m_memoryUsage = 0;
+};
\ No newline at end of file
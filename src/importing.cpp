@@ -0,0 +1,192 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "importing.h"
+#include <climits>
+#include <iostream>
+#include "imagecache.h"
+#include "mapping.h"
+
+bool LoadImageFile(const char* filePath, Image& image, const HeaderCallback& onHeader)
+{
+	// Mapping the file lets stb_image decode straight out of the page cache, avoiding the extra stdio buffering and
+	// copy that stbi_load would perform.
+	MappedFile file;
+
+	if (!file.Open(filePath)) {
+		return false;
+	}
+
+	return LoadImageMemory(file.GetData(), file.GetSize(), image, onHeader);
+}
+
+bool LoadImageMemory(const stbi_uc* buffer, const size_t length, Image& image, const HeaderCallback& onHeader)
+{
+	// stb_image takes the buffer length as an int.
+	if (length == 0 || length > INT_MAX) {
+		std::cout << "Image file is empty or too large to decode!\n";
+		return false;
+	}
+
+	if (onHeader != nullptr) {
+		int width = 0;
+		int height = 0;
+
+		// Only the header is parsed here, which is nearly free compared to the decode.
+		if (stbi_info_from_memory(buffer, static_cast<int>(length), &width, &height, nullptr) == 0) {
+			std::cout << "Failed to decode image: " << stbi_failure_reason() << '\n';
+			return false;
+		}
+
+		if (!onHeader(width, height)) {
+			return false;
+		}
+	}
+
+	stbi_uc* data = stbi_load_from_memory(buffer, static_cast<int>(length), &image.width, &image.height, nullptr, 4);
+
+	if (data == nullptr) {
+		std::cout << "Failed to decode image: " << stbi_failure_reason() << '\n';
+		return false;
+	}
+
+	image.data = data;
+	image.pixels = std::shared_ptr<stbi_uc>(data, stbi_image_free);
+	image.sourceKey.clear();
+
+	return true;
+}
+
+ImageImporter::ImageImporter(ImageCache* imageCache) : m_imageCache(imageCache)
+{
+	m_thread = std::jthread([this](const std::stop_token& stopToken) { Run(stopToken); });
+}
+
+ImageImporter::~ImageImporter()
+{
+	Cancel();
+
+	// The jthread requests a stop and joins, which wakes the worker from waiting on the queue.
+	m_thread = std::jthread();
+}
+
+void ImageImporter::Start(const char* filePath)
+{
+	Cancel();
+
+	auto job = std::make_shared<Job>();
+	job->path = filePath;
+	m_job = job;
+
+	{
+		std::lock_guard lock(m_queueMutex);
+		m_pending = std::move(job);
+	}
+
+	m_queueCondition.notify_one();
+}
+
+void ImageImporter::Run(const std::stop_token& stopToken)
+{
+	while (true) {
+		std::shared_ptr<Job> job;
+
+		{
+			std::unique_lock lock(m_queueMutex);
+
+			if (!m_queueCondition.wait(lock, stopToken, [this] { return m_pending != nullptr; })) {
+				return;
+			}
+
+			job = std::move(m_pending);
+		}
+
+		Decode(*job);
+	}
+}
+
+void ImageImporter::Decode(Job& job) const
+{
+	Image image;
+
+	bool success = false;
+
+	// There is no point reading or decoding an image that has already been replaced.
+	if (!job.cancelled) {
+		success = m_imageCache->LoadImage(job.path.c_str(), image, [&job](const int width, const int height) {
+			std::lock_guard lock(job.mutex);
+
+			job.width = width;
+			job.height = height;
+			job.headerReady = true;
+
+			return !job.cancelled;
+		});
+	}
+
+	std::lock_guard lock(job.mutex);
+
+	job.image = std::move(image);
+	job.success = success && !job.cancelled;
+	job.finished = true;
+}
+
+void ImageImporter::Cancel()
+{
+	if (m_job != nullptr) {
+		m_job->cancelled = true;
+		m_job = nullptr;
+	}
+}
+
+bool ImageImporter::PollHeader(int& width, int& height)
+{
+	if (m_job == nullptr) {
+		return false;
+	}
+
+	std::lock_guard lock(m_job->mutex);
+
+	if (!m_job->headerReady || m_job->headerCollected) {
+		return false;
+	}
+
+	m_job->headerCollected = true;
+	width = m_job->width;
+	height = m_job->height;
+
+	return true;
+}
+
+bool ImageImporter::PollResult(Image& image, bool& success)
+{
+	if (m_job == nullptr) {
+		return false;
+	}
+
+	{
+		std::lock_guard lock(m_job->mutex);
+
+		if (!m_job->finished) {
+			return false;
+		}
+
+		success = m_job->success;
+
+		if (success) {
+			image.width = m_job->image.width;
+			image.height = m_job->image.height;
+			image.pixels = std::move(m_job->image.pixels);
+			image.data = image.pixels.get();
+			image.sourceKey = std::move(m_job->image.sourceKey);
+		}
+	}
+
+	// The worker has finished with the job, so it can be let go.
+	m_job = nullptr;
+
+	return true;
+}
+
+bool ImageImporter::IsBusy() const
+{
+	return m_job != nullptr;
+}
@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include "declarations/structures.h"
+
+class ImageCache;
+
+// Called with the image dimensions as soon as the header has been read, before the pixels are decoded. Returning false
+// abandons the decode.
+using HeaderCallback = std::function<bool(int width, int height)>;
+
+// Decode an image from storage into RGBA, a file path of "-" reads the image from stdin.
+bool LoadImageFile(const char* filePath, Image& image, const HeaderCallback& onHeader = nullptr);
+// Decode an image already held in memory into RGBA.
+bool LoadImageMemory(const stbi_uc* buffer, size_t length, Image& image, const HeaderCallback& onHeader = nullptr);
+
+// Imports images on a background thread so the interface never waits on a decode. The dimensions are published as soon
+// as the header is read and the decoded image is collected later by the main thread, which owns every OpenGL call.
+// Starting a new import replaces the one in flight, whose result is discarded. Imports are decoded one at a time by a
+// single worker, a decode that is already running can not be interrupted but imports queued behind it are skipped
+// once replaced.
+class ImageImporter {
+public:
+	explicit ImageImporter(ImageCache* imageCache);
+	// An import in flight is cancelled and the worker waited for.
+	~ImageImporter();
+
+	ImageImporter(const ImageImporter&) = delete;
+	ImageImporter& operator=(const ImageImporter&) = delete;
+
+	void Start(const char* filePath);
+	void Cancel();
+
+	// Collect the dimensions of the current import, this only succeeds once per import.
+	bool PollHeader(int& width, int& height);
+	// Collect the finished image of the current import, this only succeeds once per import. Success is false if the
+	// image failed to load, in which case the image is left untouched.
+	bool PollResult(Image& image, bool& success);
+
+	[[nodiscard]] bool IsBusy() const;
+private:
+	// The state shared between the main thread and a single worker.
+	struct Job {
+		std::string path;
+
+		std::mutex mutex;
+		std::atomic<bool> cancelled = false;
+
+		bool headerReady = false;
+		bool headerCollected = false;
+		int width = 0;
+		int height = 0;
+
+		bool finished = false;
+		bool success = false;
+		Image image;
+	};
+
+	// Decode the queued jobs on the worker thread until asked to stop.
+	void Run(const std::stop_token& stopToken);
+	void Decode(Job& job) const;
+
+	ImageCache* m_imageCache = nullptr;
+	std::shared_ptr<Job> m_job;
+
+	// The next job for the worker, replaced rather than queued behind as only the latest import matters.
+	std::mutex m_queueMutex;
+	std::condition_variable_any m_queueCondition;
+	std::shared_ptr<Job> m_pending;
+
+	// Declared last so it is joined before the state it uses is destroyed.
+	std::jthread m_thread;
+};
@@ -4,31 +4,74 @@
 #include <glad/gl.h>
 #include <iostream>
 #include <numeric>
-#include <stb_image.h>
+#include <string>
 #include "compilation.h"
 #include "declarations/constants.h"
+#include "exporter/native.h"
+#include "exporting.h"
+#include "imagecache.h"
+#include "importing.h"
 #include "imgui.h"
 #include "imgui_internal.h"
+#include "meshcache.h"
 #include "nfd_glfw3.h"
 #include "renderer/render.h"
+#include "storage.h"
 
-// A simple function to send the image data to the gpu and return the pointer.
-GLuint LoadTexture(const stbi_uc* image, const int width, const int height)
+// Keep the height slider in step with the width for the aspect ratio of the area being compiled.
+void ApplyAspectRatio(const Image& image, Config* config)
 {
-	GLuint imageTexture = 0;
-	glGenTextures(1, &imageTexture);
-	glBindTexture(GL_TEXTURE_2D, imageTexture);
+	const ImageView view = GetImageView(image, config);
+	config->sliderHeight = config->sliderWidth * view.height / view.width;
+}
+
+// Let the user drag a rectangle over the source preview to select the region of interest, a right click clears it.
+void RegionOfInterestSelector(const ImVec2& origin, const ImVec2& size, const Image& image, Config* config)
+{
+	const ImGuiIO& io = ImGui::GetIO();
+	const float mouseX = std::clamp((io.MousePos.x - origin.x) / size.x, 0.0F, 1.0F);
+	const float mouseY = std::clamp((io.MousePos.y - origin.y) / size.y, 0.0F, 1.0F);
+
+	if (ImGui::IsItemHovered() && ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
+		config->roiDragging = true;
+		config->roiDragStart[0] = mouseX;
+		config->roiDragStart[1] = mouseY;
+	}
+
+	if (config->roiDragging) {
+		config->roiEnabled = true;
+		config->roi[0] = std::min(config->roiDragStart[0], mouseX);
+		config->roi[1] = std::min(config->roiDragStart[1], mouseY);
+		config->roi[2] = std::max(config->roiDragStart[0], mouseX);
+		config->roi[3] = std::max(config->roiDragStart[1], mouseY);
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		if (!ImGui::IsMouseDown(ImGuiMouseButton_Left)) {
+			config->roiDragging = false;
 
-	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
+			// A click without a drag selects nothing, so treat it as clearing the selection.
+			if (config->roi[2] - config->roi[0] < 1.0F / image.width ||
+			    config->roi[3] - config->roi[1] < 1.0F / image.height) {
+				config->roiEnabled = false;
+			}
+
+			ApplyAspectRatio(image, config);
+		}
+	}
 
-	return imageTexture;
+	if (ImGui::IsItemHovered() && ImGui::IsMouseClicked(ImGuiMouseButton_Right)) {
+		config->roiEnabled = false;
+		ApplyAspectRatio(image, config);
+	}
+
+	if (config->roiEnabled) {
+		const ImVec2 min(origin.x + config->roi[0] * size.x, origin.y + config->roi[1] * size.y);
+		const ImVec2 max(origin.x + config->roi[2] * size.x, origin.y + config->roi[3] * size.y);
+
+		ImGui::GetWindowDrawList()->AddRect(min, max, IM_COL32(255, 200, 0, 255), 0.0F, 0, 2.0F);
+	}
 }
 
-void ImportButton(GLFWwindow* window, Image& image, Config* config)
+void ImportButton(GLFWwindow* window, ImageImporter* importer)
 {
 	constexpr nfdu8filteritem_t filters[1] = {
 		{"Image", "jpg,jpeg,png,tga,bmp,psd,gif,hdr,pic"},
@@ -50,46 +93,153 @@ void ImportButton(GLFWwindow* window, Image& image, Config* config)
 		return;
 	}
 
-	if (image.data != nullptr) {
-		stbi_image_free(image.data);
+	// Load the image from storage in the background, it will automatically process any of the supported formats.
+	importer->Start(outPath);
+	// Clear the file path from memory as we are done with it.
+	NFD_FreePathU8(outPath);
+}
+
+// Reopen a saved mesh. Its arrays are copied out of the mapped file into the model, which the preview is built and
+// uploaded from like a freshly compiled mesh.
+void OpenMeshButton(GLFWwindow* window, Model& model, Config* config, Render* render, MeshCache* meshCache)
+{
+	constexpr nfdu8filteritem_t filters[1] = {
+		{"LithoGen Mesh", "lgm"},
+	};
+
+	nfdopendialogu8args_t args = {};
+	args.filterList = filters;
+	args.filterCount = 1;
+
+	NFD_GetNativeWindowFromGLFWWindow(window, &args.parentWindow);
+
+	nfdu8char_t* outPath = nullptr;
+
+	if (const nfdresult_t result = NFD_OpenDialogU8_With(&outPath, &args); result != NFD_OKAY) {
+		if (result == NFD_ERROR) {
+			std::cout << "Error: " << NFD_GetError() << '\n';
+		}
+
+		return;
 	}
 
-	// Load the image from storage, it will automatically process any of the supported formats.
-	image.data = stbi_load(outPath, &image.width, &image.height, nullptr, 4);
+	MeshFile meshFile;
+	const bool opened = meshFile.Open(outPath);
+	NFD_FreePathU8(outPath);
 
-	if (image.data == nullptr) {
-		std::cout << "Failed to load image!\n";
+	if (!opened) {
+		std::cout << "Failed to open mesh!\n";
 		return;
 	}
 
-	// Calculate the information required to gather aspect ratio based sizing.
-	const int aspectGcd = std::gcd(image.width, image.height);
-	image.aspectRatioW = image.width / aspectGcd;
-	image.aspectRatioH = image.height / aspectGcd;
+	// The model is about to be replaced, so it must no longer be written to the cache.
+	meshCache->CancelStore();
+
+	const MeshFileHeader& header = meshFile.GetHeader();
+	const Vertex* vertices = meshFile.GetVertices();
+	const uint32_t* indices = meshFile.GetIndices();
 
-	// Ensure the default width is the correct aspect ratio and reset the size when a new image is
-	// loaded.
-	config->sliderHeight = 100.0F;
-	config->sliderWidth = 100.0F * image.aspectRatioW / image.aspectRatioH;
+	// The model keeps a copy of the arrays so the mesh can be exported and uploaded once the file is unmapped.
+	model.vertices.assign(vertices, vertices + header.vertexCount);
+	model.indices.assign(indices, indices + header.indexCount);
+	model.centerOffset = glm::vec3(header.centerOffset[0], header.centerOffset[1], header.centerOffset[2]);
+	model.settings = header.settings;
+
+	ApplyMeshSettings(config, model.settings);
+
+	render->entity.LoadModel(model);
+
+	render->entity.SetPosition(-model.centerOffset);
+	render->camera.SetZoom(std::max(config->sliderWidth, config->sliderHeight) / 1.5F);
+}
 
-	if (image.texture != 0) {
-		glDeleteTextures(1, &image.texture); // Ensure the previous image has been cleaned up.
+// Apply the progress of a background import. The image is only ever swapped and uploaded here on the main thread, and
+// the current one is kept until the new one has decoded, so a file that fails to load leaves everything as it was.
+void UpdateImport(ImageImporter* importer, Image& image, Config* config, Render* render)
+{
+	// The dimensions arrive well before the pixels, so the sizing can be updated while the decode continues.
+	if (int width = 0, height = 0; importer->PollHeader(width, height)) {
+		// Ensure the default width is the correct aspect ratio and reset the size when a new image is loaded.
+		config->sliderHeight = 100.0F;
+		config->sliderWidth = 100.0F * static_cast<float>(width) / static_cast<float>(height);
 	}
 
-	// Send the image to the GPU for the renderer to preview.
-	image.texture = LoadTexture(image.data, image.width, image.height);
-	// Clear the file path from memory as we are done with it.
+	Image imported;
+
+	if (bool success = false; importer->PollResult(imported, success)) {
+		if (!success) {
+			std::cout << "Failed to load image!\n";
+			return;
+		}
+
+		// Release the previous image, the cache may still hold on to it.
+		image = std::move(imported);
+
+		// Calculate the information required to gather aspect ratio based sizing.
+		const int aspectGcd = std::gcd(image.width, image.height);
+		image.aspectRatioW = image.width / aspectGcd;
+		image.aspectRatioH = image.height / aspectGcd;
+
+		// The previous selection has no meaning for a different image.
+		config->roiEnabled = false;
+		config->roiDragging = false;
+
+		render->preview.Release();
+		render->heightField.Release();
+
+		// Send a downsampled copy of the image to the GPU for the renderer to preview.
+		render->preview.Upload(image);
+	}
+}
+
+void ExportButton(GLFWwindow* window, const Model& model, const Config* config, ModelExporter* exporter)
+{
+	if (model.indices.empty() || exporter->IsBusy()) {
+		return;
+	}
+
+	// The dialogue does not report which filter was picked, so the format is chosen by the extension of the path and
+	// the STL encoding from the file menu.
+	const nfdu8filteritem_t filters[7] = {
+		{config->exportAsciiStl ? "ASCII STL" : "Binary STL", "stl"},
+		{"3D Manufacturing Format", "3mf"},
+		{"Binary PLY", "ply"},
+		{"Wavefront OBJ", "obj"},
+		{"Binary glTF", "glb"},
+		{"LithoGen Mesh", "lgm"},
+		{"FDM Printer G-code", "gcode"},
+	};
+
+	nfdsavedialogu8args_t args = {};
+	args.filterList = filters;
+	args.filterCount = 7;
+	args.defaultName = "lithophane";
+
+	NFD_GetNativeWindowFromGLFWWindow(window, &args.parentWindow);
+
+	nfdu8char_t* outPath = nullptr;
+
+	if (const nfdresult_t result = NFD_SaveDialogU8_With(&outPath, &args); result != NFD_OKAY) {
+		if (result == NFD_ERROR) {
+			std::cout << "Error: " << NFD_GetError() << '\n';
+		}
+
+		return;
+	}
+
+	exporter->Start(outPath, model, config->exportAsciiStl, config->exportOptimized);
 	NFD_FreePathU8(outPath);
 }
 
-void ExportButton(GLFWwindow* window, const Model& model)
+void ExportSlicesButton(GLFWwindow* window, const Image& image, const Config* config, ImageCache* imageCache,
+                        ModelExporter* exporter)
 {
-	if (model.indices.empty()) {
+	if (image.data == nullptr || exporter->IsBusy()) {
 		return;
 	}
 
 	constexpr nfdu8filteritem_t filters[1] = {
-		{"Binary STL", "stl"},
+		{"Resin Layer Slices", "zip"},
 	};
 
 	nfdsavedialogu8args_t args = {};
@@ -109,21 +259,69 @@ void ExportButton(GLFWwindow* window, const Model& model)
 		return;
 	}
 
-	WriteModel(outPath, model);
+	// Slicing reads only the depth map, so no mesh has to be compiled first.
+	const ImageView view = GetImageView(image, config);
+	exporter->StartSlices(outPath, imageCache->GetDepthMap(image, view, config), view.width, view.height, *config);
 	NFD_FreePathU8(outPath);
 }
 
-void RenderInterface(GLFWwindow* window, Image& image, Config* config, Model& model, Render* render)
+// Collect the outcome of a background export, raising any error in a popup.
+void UpdateExport(ModelExporter* exporter, Config* config)
 {
+	if (bool success = false; exporter->PollResult(success, config->exportError) && !success) {
+		if (!config->exportError.empty()) {
+			ImGui::OpenPopup("Export Failed");
+		}
+	}
+
+	ImGui::SetNextWindowPos(ImGui::GetMainViewport()->GetCenter(), ImGuiCond_Appearing, ImVec2(0.5F, 0.5F));
+
+	if (ImGui::BeginPopupModal("Export Failed", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+		ImGui::TextUnformatted(config->exportError.c_str());
+
+		if (ImGui::Button("OK")) {
+			ImGui::CloseCurrentPopup();
+		}
+
+		ImGui::EndPopup();
+	}
+}
+
+void RenderInterface(GLFWwindow* window, Image& image, Config* config, Model& model, Render* render,
+                     ImageCache* imageCache, MeshCache* meshCache, ImageImporter* importer, ModelExporter* exporter)
+{
+	UpdateImport(importer, image, config, render);
+	UpdateExport(exporter, config);
+
 	// Menu bar
 	if (ImGui::BeginMainMenuBar()) {
 		if (ImGui::BeginMenu("File")) {
 			if (ImGui::MenuItem("Import")) {
-				ImportButton(window, image, config);
+				ImportButton(window, importer);
+			}
+			// Opening replaces the model an export or the preview is reading.
+			if (ImGui::MenuItem("Open Mesh", nullptr, false, !exporter->IsBusy() && !render->entity.IsUploading())) {
+				OpenMeshButton(window, model, config, render, meshCache);
+			}
+			if (ImGui::MenuItem("Export", nullptr, false, !exporter->IsBusy())) {
+				ExportButton(window, model, config, exporter);
+			}
+			if (ImGui::MenuItem("Export Layer Slices", nullptr, false, image.data != nullptr && !exporter->IsBusy())) {
+				ExportSlicesButton(window, image, config, imageCache, exporter);
 			}
-			if (ImGui::MenuItem("Export")) {
-				ExportButton(window, model);
+			ImGui::MenuItem("Export STL As ASCII", nullptr, &config->exportAsciiStl);
+			ImGui::MenuItem("Optimise Exported Vertex Order", nullptr, &config->exportOptimized);
+			ImGui::Separator();
+			// Without a cache directory images would be spilled relative to the working directory, so spilling is
+			// unavailable instead.
+			const std::filesystem::path cacheDirectory = GetCacheDirectory();
+			if (ImGui::MenuItem("Spill Image Cache To Disk", nullptr, &config->cacheSpill, !cacheDirectory.empty())) {
+				imageCache->SetSpillDirectory(config->cacheSpill ? cacheDirectory / "images" : std::filesystem::path());
+			}
+			if (ImGui::MenuItem("Cache Compiled Meshes", nullptr, &config->cacheMeshes)) {
+				meshCache->SetCacheDirectory(config->cacheMeshes ? GetCacheDirectory() : std::filesystem::path());
 			}
+			ImGui::Separator();
 			if (ImGui::MenuItem("Quit", "Alt+F4")) {
 				glfwSetWindowShouldClose(window, GL_TRUE);
 			}
@@ -133,9 +331,9 @@ void RenderInterface(GLFWwindow* window, Image& image, Config* config, Model& mo
 			ImGui::MenuItem("Show Source", nullptr, &config->drawSource);
 			ImGui::Separator();
 			ImGui::MenuItem("Show Preview", nullptr, &config->drawPreview);
-			if (ImGui::MenuItem("Wireframe Preview", "W", &config->drawWireframe)) {
-				render->UpdateWireframe();
-			}
+			ImGui::MenuItem("Live Height Field Preview", nullptr, &config->drawHeightField);
+			ImGui::MenuItem("Wireframe Preview", "W", &config->drawWireframe);
+			ImGui::MenuItem("Reduce Quality While Moving", nullptr, &config->drawReducedWhileMoving);
 			if (ImGui::MenuItem("Reset Preview Rotation", "R")) {
 				render->camera.ResetRotation();
 			}
@@ -166,26 +364,57 @@ void RenderInterface(GLFWwindow* window, Image& image, Config* config, Model& mo
 	             ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse |
 	                 ImGuiWindowFlags_NoTitleBar);
 
+	// Shown above everything else as it must stay usable while there is no image.
+	if (exporter->IsBusy()) {
+		ImGui::Text("Exporting...");
+		ImGui::ProgressBar(exporter->GetProgress(), ImVec2(-FLT_MIN, 0.0F));
+
+		if (ImGui::Button("Cancel Export")) {
+			exporter->Cancel();
+		}
+	}
+
 	if (image.data == nullptr) {
 		ImGui::PushItemFlag(ImGuiItemFlags_Disabled, true);
 		ImGui::PushStyleVar(ImGuiStyleVar_Alpha, ImGui::GetStyle().Alpha * 0.5F);
 	}
 
+	if (importer->IsBusy()) {
+		ImGui::TextDisabled("Loading image...");
+	}
+
+	if (render->entity.IsUploading()) {
+		ImGui::TextDisabled("Uploading mesh...");
+	}
+
 	ImGui::SeparatorText("Mesh Configuration");
 
 	ImGui::Combo("Mesh Type", &config->dropdownMesh, config->dropdownMeshTypes,
 	             IM_ARRAYSIZE(config->dropdownMeshTypes));
 
+	// The area of the image that will be compiled, either all of it or the selected region of interest.
+	const ImageView view = GetImageView(image, config);
+
+	if (config->roiEnabled) {
+		ImGui::Text("Crop: %d x %d px", view.width, view.height);
+		ImGui::SameLine();
+
+		if (ImGui::SmallButton("Clear")) {
+			config->roiEnabled = false;
+			ApplyAspectRatio(image, config);
+		}
+	}
+
 	ImGui::Text("Dimensions");
 
 	// TODO: The forced ratio does not clamp.
 	if (ImGui::SliderFloat("Width", &config->sliderWidth, SLIDER_WIDTH_MIN, SLIDER_WIDTH_MAX, SLIDER_FLOAT_FORMAT_MM)) {
-		config->sliderHeight = config->sliderWidth * image.aspectRatioH / image.aspectRatioW;
+		config->sliderHeight = config->sliderWidth * view.height / view.width;
 	}
 
 	if (ImGui::SliderFloat("Height", &config->sliderHeight, SLIDER_HEIGHT_MIN, SLIDER_HEIGHT_MAX,
 	                       SLIDER_FLOAT_FORMAT_MM)) {
-		config->sliderWidth = config->sliderHeight * image.aspectRatioW / image.aspectRatioH;
+		config->sliderWidth = config->sliderHeight * view.width / view.height;
 	}
 
 	ImGui::Text("Thickness");
@@ -213,13 +442,57 @@ void RenderInterface(GLFWwindow* window, Image& image, Config* config, Model& mo
 	ImGui::SliderFloat("Alpha", &config->sliderGsPref[3], 0.0F, 1.0F, SLIDER_FLOAT_FORMAT,
 	                   ImGuiSliderFlags_AlwaysClamp); */
 
+	// The height field follows the settings as they change, its depth map is only sent again when the pixels or the
+	// grayscale preference behind it differ.
+	if (config->drawHeightField && image.data != nullptr) {
+		if (const std::string key = BuildDepthKey(image, view, config); key != render->heightField.GetKey()) {
+			const bool first = !render->heightField.IsValid();
+
+			render->heightField.Upload(*imageCache->GetDepthMap(image, view, config), view.width, view.height, key);
+
+			// Focus on the height field when it first appears, as compiling does for a mesh.
+			if (first) {
+				render->camera.SetZoom(std::max(config->sliderWidth, config->sliderHeight) / 1.5F);
+			}
+		}
+	}
+
+	ImGui::SeparatorText("Resin Slicing");
+
+	ImGui::SliderFloat("Pixel Size", &config->slicePixelSize, SLIDER_SLICE_MIN, SLIDER_SLICE_MAX,
+	                   SLIDER_FLOAT_FORMAT_MM, ImGuiSliderFlags_AlwaysClamp);
+	ImGui::SliderFloat("Layer Height", &config->sliceLayerHeight, SLIDER_SLICE_MIN, SLIDER_SLICE_MAX,
+	                   SLIDER_FLOAT_FORMAT_MM, ImGuiSliderFlags_AlwaysClamp);
+
 	ImGui::Spacing();
 
-	if (ImGui::Button("Compile")) {
+	// Compiling replaces the model an export or the preview is reading, so it waits until both have finished.
+	ImGui::BeginDisabled(exporter->IsBusy() || render->entity.IsUploading());
+	const bool compile = ImGui::Button("Compile");
+	ImGui::EndDisabled();
+
+	if (compile) {
 		// TODO: Add some visual indicator that the process is on going.
 		// Ideally place the compile processes onto a different thread so some sort of simple animation can play on the
 		// loading popup to indicate it has not crashed.
-		CompileModel(model, config, image);
+		const MeshSettings settings = GetMeshSettings(config, view);
+
+		// The model is about to be replaced, so a store of the previous one still in flight is abandoned.
+		meshCache->CancelStore();
+
+		// A mesh compiled before from the same pixels and settings is read back instead of compiled again.
+		if (!meshCache->LoadModel(settings, model)) {
+			const std::shared_ptr<const std::vector<float>> depthMap = imageCache->GetDepthMap(image, view, config);
+
+			CompileModel(model, config, view, *depthMap);
+			model.settings = settings;
+
+			// Writing a large mesh takes a while, so it is cached in the background.
+			if (config->cacheMeshes) {
+				meshCache->StartStore(model);
+			}
+		}
+
 		render->entity.LoadModel(model);
 
 		// Offset the position by the centre offset.
@@ -236,9 +509,17 @@ void RenderInterface(GLFWwindow* window, Image& image, Config* config, Model& mo
 		ImGui::PopStyleVar();
 	}
 
+	if (config->cacheMeshes) {
+		ImGui::SeparatorText("Mesh Cache");
+		ImGui::TextDisabled("%s", meshCache->GetStats().c_str());
+	}
+
 	ImGui::End();
 
-	if (config->drawSource && image.texture != 0) {
+	// Swap in the source preview texture once its upload has completed.
+	render->preview.Poll();
+
+	if (config->drawSource && render->preview.GetTexture() != 0) {
 		// Place the source preview in the bottom right corner.
 		// Add 10 pixels of padding to the window edge.
 		float previewWidth = 128.0F;
@@ -260,7 +541,10 @@ void RenderInterface(GLFWwindow* window, Image& image, Config* config, Model& mo
 		ImGui::Begin("Source Preview", nullptr,
 		             ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoTitleBar |
 		                 ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoBackground);
-		ImGui::Image(image.texture, ImVec2(previewWidth, previewHeight));
+		const ImVec2 previewOrigin = ImGui::GetCursorScreenPos();
+
+		ImGui::Image(render->preview.GetTexture(), ImVec2(previewWidth, previewHeight));
+		RegionOfInterestSelector(previewOrigin, ImVec2(previewWidth, previewHeight), image, config);
 		ImGui::End();
 
 		ImGui::PopStyleVar();
@@ -290,16 +574,27 @@ void RenderInterface(GLFWwindow* window, Image& image, Config* config, Model& mo
 
 		if (ImGui::CollapsingHeader("Controls", ImGuiTreeNodeFlags_DefaultOpen)) {
 			ImGui::TextWrapped("Sliders can be control clicked to enter specific numbers manually.\nThe 3D preview can "
-			                   "be dragged to rotate the camera and mouse wheel will zoom in and out.");
+			                   "be dragged to rotate the camera and mouse wheel will zoom in and out.\nDragging over "
+			                   "the source preview selects a region to crop to, right clicking it clears the crop.");
 		}
 
 		if (ImGui::CollapsingHeader("Importing and Exporting", ImGuiTreeNodeFlags_DefaultOpen)) {
-			ImGui::TextWrapped("Under file, dialogues for loading images and saving models can be found.");
+			ImGui::TextWrapped("Under file, dialogues for loading images and saving models can be found. Images can "
+			                   "also be dropped onto the window to load them. Meshes saved as LithoGen Mesh files "
+			                   "can be opened again along with their settings, without the image or compiling. "
+			                   "Models are saved in the background, with progress shown at the top of the side "
+			                   "panel where the export can be cancelled. Compiled meshes and exports are kept in a "
+			                   "cache on disk, so repeating one with the same image and settings is instant. PLY, OBJ "
+			                   "and GLB exports can have their vertex order optimised for rendering.");
 		}
 
 		if (ImGui::CollapsingHeader("View Customisation", ImGuiTreeNodeFlags_DefaultOpen)) {
 			ImGui::TextWrapped(
-				"Under view, various checkboxes can be found to hide or adjust elements of the 3D model viewer.");
+				"Under view, various checkboxes can be found to hide or adjust elements of the 3D model viewer. The "
+				"live height field preview shows the lithophane straight from the image without compiling, "
+				"following the settings as they are changed. Compile is still needed to export a model. While "
+				"the camera moves, the preview is drawn at a lower resolution and large meshes are simplified, "
+				"returning to full quality once it stops.");
 		}
 
 		if (ImGui::CollapsingHeader("Settings Explanation", ImGuiTreeNodeFlags_DefaultOpen)) {
@@ -320,6 +615,18 @@ void RenderInterface(GLFWwindow* window, Image& image, Config* config, Model& mo
 				"This setting adjusts how red, green and blue are weighted when generating the single height "
 				"value per pixel, this should usually be left as default unless there is a specific reason to "
 				"change it.");
+
+			ImGui::SeparatorText("Resin Slicing");
+			ImGui::TextWrapped(
+				"The pixel size of the printer screen and the layer height used when exporting layer slices. "
+				"Layer slices are written straight from the image as one mask per layer, ready for a resin "
+				"printer, without compiling a mesh.");
+
+			ImGui::SeparatorText("FDM Printing");
+			ImGui::TextWrapped(
+				"Exporting as G-code slices the compiled mesh for a filament printer, with its back on the bed. The "
+				"printer, filament and speeds are read from printer.ini in the configuration directory, which is "
+				"created with default values on the first G-code export.");
 		}
 
 		ImGui::End();
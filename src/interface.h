@@ -4,6 +4,11 @@
 #include "GLFW/glfw3.h"
 #include "declarations/config.h"
 #include "declarations/structures.h"
+#include "exporting.h"
+#include "imagecache.h"
+#include "importing.h"
+#include "meshcache.h"
 #include "renderer/render.h"
 
-void RenderInterface(GLFWwindow* window, Image& image, Config* config, Model& model, Render* render);
\ No newline at end of file
+void RenderInterface(GLFWwindow* window, Image& image, Config* config, Model& model, Render* render,
+                     ImageCache* imageCache, MeshCache* meshCache, ImageImporter* importer, ModelExporter* exporter);
\ No newline at end of file
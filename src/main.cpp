@@ -2,20 +2,36 @@
 #include <GLFW/glfw3.h>
 #include <backends/imgui_impl_glfw.h>
 #include <backends/imgui_impl_opengl3.h>
+#include <chrono>
+#include <cstring>
 #include <glad/gl.h>
 #include <imgui.h>
 #include <iostream>
 #include <nfd_glfw3.h>
 #include <numeric>
+#include "batch.h"
 #include "control.h"
 #include "declarations/config.h"
 #include "declarations/constants.h"
 #include "declarations/structures.h"
+#include "exporting.h"
+#include "imagecache.h"
 #include "interface.h"
+#include "meshcache.h"
 #include "renderer/render.h"
+#include "storage.h"
 
 int main(int argc, char* argv[])
 {
+	// Jobs given on the command line are run without ever opening a window.
+	if (argc > 1 && strcmp(argv[1], "--batch") == 0) {
+		return RunBatch(argc - 2, argv + 2);
+	}
+
+	// Startup is timed up to the first frame on screen.
+	const auto startTime = std::chrono::high_resolution_clock::now();
+	bool firstFrame = true;
+
 	// Initialize the GLFW3 library.
 	if (glfwInit() == 0) {
 		return 1;
@@ -48,9 +64,13 @@ int main(int argc, char* argv[])
 		return 1;
 	}
 
-	// Don't draw the backside of a triangle.
+	// Wait for the display between frames, so frames drawn back to back never outpace it.
+	glfwSwapInterval(1);
+
+	// Don't draw the backside of a triangle, triangles are wound counter-clockwise seen from the outside as every mesh
+	// format expects.
 	glEnable(GL_CULL_FACE);
-	glFrontFace(GL_CW);
+	glFrontFace(GL_CCW);
 	glCullFace(GL_BACK);
 
 	// Enable the depth buffer.
@@ -65,6 +85,10 @@ int main(int argc, char* argv[])
 	glfwSetKeyCallback(mainWindow, KeyCallback);
 	glfwSetCursorPosCallback(mainWindow, CursorPosCallback);
 	glfwSetScrollCallback(mainWindow, ScrollCallback);
+	glfwSetDropCallback(mainWindow, DropCallback);
+	glfwSetMouseButtonCallback(mainWindow, MouseButtonCallback);
+	glfwSetCharCallback(mainWindow, CharCallback);
+	glfwSetWindowRefreshCallback(mainWindow, WindowRefreshCallback);
 
 	// ImGui initialisation.
 	ImGui::CreateContext();
@@ -80,7 +104,15 @@ int main(int argc, char* argv[])
 	// It is better to let the kernel clean these up as the program will close faster.
 	auto* config = new Config();
 	auto* render = new Render(mainWindow, config);
-	auto* glfwUser = new glfwUserData(config, render);
+	auto* imageCache = new ImageCache(IMAGE_CACHE_MEMORY_CAP);
+	auto* meshCache = new MeshCache(MESH_CACHE_DISK_CAP);
+	auto* importer = new ImageImporter(imageCache);
+	auto* exporter = new ModelExporter(meshCache);
+	auto* glfwUser = new glfwUserData(config, render, importer);
+
+	if (config->cacheMeshes) {
+		meshCache->SetCacheDirectory(GetCacheDirectory());
+	}
 
 	// Make this object accessible from within any GLFW callback.
 	glfwSetWindowUserPointer(mainWindow, glfwUser);
@@ -90,6 +122,19 @@ int main(int argc, char* argv[])
 	Model model;
 
 	while (glfwWindowShouldClose(mainWindow) == 0) {
+		// Work in the background shows its progress in the interface, so frames keep being drawn until it finishes.
+		const bool progressing = importer->IsBusy() || exporter->IsBusy();
+
+		if (progressing || render->IsBusy()) {
+			render->RequestRedraw();
+		}
+
+		// Nothing is drawn while nothing on screen can have changed, leaving the CPU and GPU idle.
+		if (!render->ConsumeRedraw()) {
+			glfwWaitEventsTimeout(IDLE_WAIT_TIMEOUT);
+			continue;
+		}
+
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // Clear the color and depth buffer to avoid any junk.
 
 		render->Draw();
@@ -99,7 +144,7 @@ int main(int argc, char* argv[])
 		ImGui_ImplGlfw_NewFrame();
 		ImGui::NewFrame();
 
-		RenderInterface(mainWindow, image, config, model, render);
+		RenderInterface(mainWindow, image, config, model, render, imageCache, meshCache, importer, exporter);
 
 		// Trigger an ImGui render.
 		ImGui::Render();
@@ -107,11 +152,29 @@ int main(int argc, char* argv[])
 
 		// Push the prepared frame buffer to the screen.
 		glfwSwapBuffers(mainWindow);
-		// Process the OS's window events, in other words, gathering inputs and window state from the OS.
-		glfwPollEvents();
+
+		if (firstFrame) {
+			const std::chrono::duration<double, std::milli> elapsedTime =
+				std::chrono::high_resolution_clock::now() - startTime;
+
+			std::cout << "First frame shown in " << elapsedTime.count() << "ms\n";
+			firstFrame = false;
+		}
+
+		// Process the OS's window events, in other words, gathering inputs and window state from the OS. Progress bars
+		// only need a few updates a second, while uploads to the GPU advance with every frame drawn.
+		if (progressing && !render->IsBusy()) {
+			glfwWaitEventsTimeout(PROGRESS_WAIT_TIMEOUT);
+		} else {
+			glfwPollEvents();
+		}
 	}
 
 	// Cleanup
+	// Unlike the rest, exports and cache stores in flight must be stopped so their partial files are removed.
+	delete exporter;
+	delete meshCache;
+
 	glfwTerminate();
 	NFD_Quit();
 
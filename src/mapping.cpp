@@ -0,0 +1,238 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "mapping.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#ifdef OS_WINDOWS
+#include <fcntl.h>
+#include <io.h>
+#include <string>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// The size of each read when falling back to reading a stream.
+constexpr size_t STREAM_READ_SIZE = 1 << 20;
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#ifdef OS_WINDOWS
+
+bool MappedFile::Open(const char* filePath)
+{
+	Close();
+
+	if (strcmp(filePath, "-") == 0) {
+		_setmode(_fileno(stdin), _O_BINARY);
+		return ReadStream(GetStdHandle(STD_INPUT_HANDLE));
+	}
+
+	// The paths given by the file dialogue are UTF-8, so they must be widened for the Windows API.
+	const int wideLength = MultiByteToWideChar(CP_UTF8, 0, filePath, -1, nullptr, 0);
+	std::wstring widePath(wideLength, L'\0');
+	MultiByteToWideChar(CP_UTF8, 0, filePath, -1, widePath.data(), wideLength);
+
+	const HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+	                                FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE) {
+		std::cout << "Failed to open \"" << filePath << "\"!\n";
+		return false;
+	}
+
+	LARGE_INTEGER fileSize = {};
+
+	if (GetFileType(file) != FILE_TYPE_DISK || GetFileSizeEx(file, &fileSize) == 0 || fileSize.QuadPart == 0) {
+		const bool success = ReadStream(file);
+		CloseHandle(file);
+		return success;
+	}
+
+	const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	void* view = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+	// The view keeps the file alive on its own, so neither handle is needed past this point.
+	if (mapping != nullptr) {
+		CloseHandle(mapping);
+	}
+
+	if (view == nullptr) {
+		const bool success = ReadStream(file);
+		CloseHandle(file);
+		return success;
+	}
+
+	CloseHandle(file);
+
+	m_data = static_cast<const unsigned char*>(view);
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+	m_mapped = true;
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_mapped) {
+		UnmapViewOfFile(m_data);
+	}
+
+	m_data = nullptr;
+	m_size = 0;
+	m_mapped = false;
+	m_buffer = {};
+}
+
+bool MappedFile::ReadStream(void* handle)
+{
+	size_t used = 0;
+
+	while (true) {
+		m_buffer.resize(used + STREAM_READ_SIZE);
+
+		DWORD bytesRead = 0;
+
+		if (ReadFile(handle, m_buffer.data() + used, STREAM_READ_SIZE, &bytesRead, nullptr) == 0) {
+			// A closed pipe reports an error in place of the end of the file.
+			if (GetLastError() == ERROR_BROKEN_PIPE) {
+				break;
+			}
+
+			std::cout << "Failed to read file stream!\n";
+			m_buffer = {};
+			return false;
+		}
+
+		if (bytesRead == 0) {
+			break;
+		}
+
+		used += bytesRead;
+	}
+
+	m_buffer.resize(used);
+	m_data = m_buffer.data();
+	m_size = used;
+
+	return true;
+}
+
+#else
+
+bool MappedFile::Open(const char* filePath)
+{
+	Close();
+
+	if (strcmp(filePath, "-") == 0) {
+		int descriptor = STDIN_FILENO;
+		return ReadStream(&descriptor);
+	}
+
+	int descriptor = open(filePath, O_RDONLY);
+
+	if (descriptor < 0) {
+		std::cout << "Failed to open \"" << filePath << "\"!\n";
+		return false;
+	}
+
+	struct stat status = {};
+
+	// Only regular files have a fixed size that can be mapped, anything else is read as a stream.
+	if (fstat(descriptor, &status) != 0 || !S_ISREG(status.st_mode) || status.st_size == 0) {
+		const bool success = ReadStream(&descriptor);
+		close(descriptor);
+		return success;
+	}
+
+	void* view = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+	if (view == MAP_FAILED) {
+		const bool success = ReadStream(&descriptor);
+		close(descriptor);
+		return success;
+	}
+
+	// The mapping keeps its own reference to the file.
+	close(descriptor);
+
+	// The decoders read front to back, so let the kernel read ahead aggressively and drop pages behind us.
+	madvise(view, status.st_size, MADV_SEQUENTIAL);
+
+	m_data = static_cast<const unsigned char*>(view);
+	m_size = static_cast<size_t>(status.st_size);
+	m_mapped = true;
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_mapped) {
+		munmap(const_cast<unsigned char*>(m_data), m_size);
+	}
+
+	m_data = nullptr;
+	m_size = 0;
+	m_mapped = false;
+	m_buffer = {};
+}
+
+bool MappedFile::ReadStream(void* handle)
+{
+	const int descriptor = *static_cast<int*>(handle);
+	size_t used = 0;
+
+	while (true) {
+		m_buffer.resize(used + STREAM_READ_SIZE);
+
+		const ssize_t bytesRead = read(descriptor, m_buffer.data() + used, STREAM_READ_SIZE);
+
+		if (bytesRead < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			std::cout << "Failed to read file stream!\n";
+			m_buffer = {};
+			return false;
+		}
+
+		if (bytesRead == 0) {
+			break;
+		}
+
+		used += bytesRead;
+	}
+
+	m_buffer.resize(used);
+	m_data = m_buffer.data();
+	m_size = used;
+
+	return true;
+}
+
+#endif
+
+const unsigned char* MappedFile::GetData() const
+{
+	return m_data;
+}
+
+size_t MappedFile::GetSize() const
+{
+	return m_size;
+}
+
+bool MappedFile::IsMapped() const
+{
+	return m_mapped;
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// A read-only view of a whole file. Regular files are memory mapped so the page cache is read directly, anything that
+// cannot be mapped (pipes, stdin, character devices) is read into an owned buffer instead.
+class MappedFile {
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// Open a file by its UTF-8 path, a path of "-" reads from stdin.
+	bool Open(const char* filePath);
+	void Close();
+
+	[[nodiscard]] const unsigned char* GetData() const;
+	[[nodiscard]] size_t GetSize() const;
+	[[nodiscard]] bool IsMapped() const;
+private:
+	bool ReadStream(void* handle);
+
+	const unsigned char* m_data = nullptr;
+	size_t m_size = 0;
+	bool m_mapped = false;
+
+	// Storage for the fallback path when the source can not be mapped.
+	std::vector<unsigned char> m_buffer;
+};
\ No newline at end of file
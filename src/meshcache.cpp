@@ -0,0 +1,370 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "meshcache.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "compilation.h"
+#include "declarations/constants.h"
+#include "exporter/file.h"
+#include "exporter/native.h"
+#include "exporting.h"
+#include "hashing.h"
+#include "mapping.h"
+
+// Records the settings a source file was compiled with, followed by the source key to resolve collisions.
+struct SourceRecord {
+	char magic[4] = {'L', 'G', 'S', 'R'};
+	uint32_t keyLength = 0;
+	MeshSettings settings;
+};
+
+// The content address of a mesh. The region is ignored while it is disabled, as it has no effect on the mesh.
+uint64_t GetMeshKey(MeshSettings settings)
+{
+	if (settings.roiEnabled == 0) {
+		std::ranges::copy(MeshSettings().roi, settings.roi);
+	}
+
+	return CombineHash(MESH_CACHE_VERSION, HashBytes(&settings, sizeof(MeshSettings)));
+}
+
+// The address of a request for a source file, made before it has been decoded. Everything derived from the pixels is
+// left out, including the height as it follows from the width and aspect ratio.
+uint64_t GetSourceKey(const std::string& sourceKey, const Config* config)
+{
+	MeshSettings settings = GetMeshSettings(config, ImageView());
+	settings.height = 0.0F;
+
+	return CombineHash(HashBytes(sourceKey.data(), sourceKey.size()), GetMeshKey(settings));
+}
+
+std::string GetEntryName(const uint64_t key, const std::string& suffix)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+
+	return name + suffix;
+}
+
+// G-code also depends on the printer profile, which is not part of the key, so it is never cached.
+bool IsCachedExport(const char* filePath)
+{
+	return GetExportExtension(filePath) != ".gcode";
+}
+
+// Exports are stored under the extension of their format, ASCII STL files and optimised vertex orders are kept apart
+// from the default ones.
+std::string GetExportSuffix(const char* filePath, const bool ascii, const bool optimize)
+{
+	const std::string extension = GetExportExtension(filePath);
+
+	if (optimize && IsVertexOrderExport(filePath)) {
+		return "-optimized" + extension;
+	}
+
+	return ascii && extension == ".stl" ? "-ascii.stl" : extension;
+}
+
+// Copy a file by writing it beside the destination and renaming it into place, so the destination is never partial.
+bool CopyFileAtomic(const std::filesystem::path& fromPath, const std::string& toPath)
+{
+	MappedFile source;
+
+	if (!source.Open(fromPath.string().c_str())) {
+		return false;
+	}
+
+	const std::string temporaryPath = GetTemporaryPath(toPath);
+	OutputFile file;
+
+	bool success = file.Open(temporaryPath.c_str()) && file.Reserve(source.GetSize()) &&
+	               file.WriteAt(source.GetData(), source.GetSize(), 0);
+	success = file.Close() && success && RenameFile(temporaryPath.c_str(), toPath.c_str());
+
+	if (!success) {
+		RemoveFile(temporaryPath.c_str());
+	}
+
+	return success;
+}
+
+MeshCache::MeshCache(const uint64_t diskCap) : m_diskCap(diskCap) {}
+
+MeshCache::~MeshCache()
+{
+	CancelStore();
+}
+
+void MeshCache::SetCacheDirectory(const std::filesystem::path& cacheDirectory)
+{
+	std::lock_guard lock(m_mutex);
+
+	m_directory = cacheDirectory.empty() ? cacheDirectory : cacheDirectory / "meshes";
+
+	if (!m_directory.empty()) {
+		std::error_code error;
+		std::filesystem::create_directories(m_directory, error);
+
+		if (error) {
+			std::cout << "Failed to create mesh cache directory: " << error.message() << '\n';
+			m_directory.clear();
+		}
+	}
+}
+
+bool MeshCache::LoadModel(const MeshSettings& settings, Model& model)
+{
+	const std::filesystem::path path = Find(GetEntryName(GetMeshKey(settings), ".lgm"));
+	MeshFile file;
+
+	if (!m_models.Record(!path.empty() && file.Open(path.string().c_str()))) {
+		return false;
+	}
+
+	const MeshFileHeader& header = file.GetHeader();
+
+	model.vertices.assign(file.GetVertices(), file.GetVertices() + header.vertexCount);
+	model.indices.assign(file.GetIndices(), file.GetIndices() + header.indexCount);
+	model.centerOffset = glm::vec3(header.centerOffset[0], header.centerOffset[1], header.centerOffset[2]);
+	model.settings = header.settings;
+
+	std::cout << "Loaded mesh from cache.\n";
+	return true;
+}
+
+void MeshCache::StoreModel(const Model& model, ExportProgress& progress)
+{
+	const std::filesystem::path directory = GetDirectory();
+
+	if (directory.empty() || model.settings.sourceHash == 0) {
+		return;
+	}
+
+	// An entry larger than the whole cache would only be trimmed again, after evicting everything else.
+	const uint64_t size = model.vertices.size() * sizeof(Vertex) + model.indices.size() * sizeof(uint32_t);
+
+	if (size > m_diskCap) {
+		return;
+	}
+
+	std::string error;
+	const std::filesystem::path path = directory / GetEntryName(GetMeshKey(model.settings), ".lgm");
+
+	if (WriteModel(path.string().c_str(), model, false, false, progress, error)) {
+		Trim();
+	}
+}
+
+void MeshCache::StartStore(const Model& model)
+{
+	CancelStore();
+
+	auto progress = std::make_shared<ExportProgress>();
+	m_storeProgress = progress;
+
+	m_storeThread = std::jthread([this, &model, progress] { StoreModel(model, *progress); });
+}
+
+void MeshCache::CancelStore()
+{
+	if (m_storeProgress == nullptr) {
+		return;
+	}
+
+	m_storeProgress->Cancel();
+
+	// Joining here rather than on the next start means the model is no longer read once this returns.
+	m_storeThread = std::jthread();
+	m_storeProgress = nullptr;
+}
+
+bool MeshCache::LoadExport(const MeshSettings& settings, const char* filePath, const bool ascii,
+                           const bool optimize)
+{
+	// A mesh without a known source can not be addressed.
+	if (settings.sourceHash == 0 || !IsCachedExport(filePath)) {
+		return false;
+	}
+
+	const std::filesystem::path path =
+		Find(GetEntryName(GetMeshKey(settings), GetExportSuffix(filePath, ascii, optimize)));
+
+	if (!m_exports.Record(!path.empty() && CopyFileAtomic(path, filePath))) {
+		return false;
+	}
+
+	std::cout << "Copied export from cache to \"" << filePath << "\".\n";
+	return true;
+}
+
+void MeshCache::StoreExport(const MeshSettings& settings, const char* filePath, const bool ascii,
+                            const bool optimize)
+{
+	const std::filesystem::path directory = GetDirectory();
+
+	if (directory.empty() || settings.sourceHash == 0 || !IsCachedExport(filePath)) {
+		return;
+	}
+
+	std::error_code error;
+
+	if (std::filesystem::file_size(filePath, error) > m_diskCap || error) {
+		return;
+	}
+
+	const std::filesystem::path path =
+		directory / GetEntryName(GetMeshKey(settings), GetExportSuffix(filePath, ascii, optimize));
+
+	if (CopyFileAtomic(filePath, path.string())) {
+		Trim();
+	}
+}
+
+bool MeshCache::LookupSource(const std::string& sourceKey, const Config* config, MeshSettings& settings)
+{
+	const std::filesystem::path path = Find(GetEntryName(GetSourceKey(sourceKey, config), ".source"));
+	MappedFile file;
+
+	if (path.empty() || !file.Open(path.string().c_str()) ||
+	    file.GetSize() != sizeof(SourceRecord) + sourceKey.size()) {
+		return m_sources.Record(false);
+	}
+
+	SourceRecord record;
+	memcpy(&record, file.GetData(), sizeof(SourceRecord));
+
+	// Reject foreign files and hash collisions.
+	if (memcmp(record.magic, SourceRecord().magic, 4) != 0 || record.keyLength != sourceKey.size() ||
+	    memcmp(file.GetData() + sizeof(SourceRecord), sourceKey.data(), sourceKey.size()) != 0) {
+		return m_sources.Record(false);
+	}
+
+	settings = record.settings;
+
+	return m_sources.Record(true);
+}
+
+void MeshCache::StoreSource(const std::string& sourceKey, const Config* config, const MeshSettings& settings)
+{
+	const std::filesystem::path directory = GetDirectory();
+
+	if (directory.empty() || sourceKey.empty()) {
+		return;
+	}
+
+	SourceRecord record;
+	record.keyLength = static_cast<uint32_t>(sourceKey.size());
+	record.settings = settings;
+
+	const std::string path = (directory / GetEntryName(GetSourceKey(sourceKey, config), ".source")).string();
+	const std::string temporaryPath = GetTemporaryPath(path);
+	OutputFile file;
+
+	bool success = file.Open(temporaryPath.c_str()) && file.WriteAt(&record, sizeof(SourceRecord), 0) &&
+	               file.WriteAt(sourceKey.data(), sourceKey.size(), sizeof(SourceRecord));
+	success = file.Close() && success && RenameFile(temporaryPath.c_str(), path.c_str());
+
+	if (!success) {
+		RemoveFile(temporaryPath.c_str());
+	}
+}
+
+std::string MeshCache::GetStats() const
+{
+	std::string stats;
+
+	const auto describe = [&stats](const char* name, const Counter& counter) {
+		const uint64_t hits = counter.hits;
+		const uint64_t lookups = hits + counter.misses;
+		const double rate = lookups == 0 ? 0.0 : 100.0 * static_cast<double>(hits) / static_cast<double>(lookups);
+
+		char line[96];
+		snprintf(line, sizeof(line), "%s: %llu of %llu hit (%.0f%%)\n", name, static_cast<unsigned long long>(hits),
+		         static_cast<unsigned long long>(lookups), rate);
+		stats += line;
+	};
+
+	describe("Sources", m_sources);
+	describe("Meshes", m_models);
+	describe("Exports", m_exports);
+
+	stats.pop_back();
+
+	return stats;
+}
+
+bool MeshCache::Counter::Record(const bool hit)
+{
+	++(hit ? hits : misses);
+
+	return hit;
+}
+
+std::filesystem::path MeshCache::Find(const std::string& name) const
+{
+	const std::filesystem::path directory = GetDirectory();
+
+	if (directory.empty()) {
+		return {};
+	}
+
+	std::filesystem::path path = directory / name;
+	std::error_code error;
+
+	if (!std::filesystem::is_regular_file(path, error)) {
+		return {};
+	}
+
+	// The modification time orders entries by their last use.
+	std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+
+	return path;
+}
+
+void MeshCache::Trim() const
+{
+	const std::filesystem::path directory = GetDirectory();
+
+	struct CacheFile {
+		std::filesystem::path path;
+		std::filesystem::file_time_type modified;
+		uintmax_t size;
+	};
+
+	// Only one thread trims at a time, so two do not both remove the same entries.
+	std::lock_guard lock(m_mutex);
+
+	std::vector<CacheFile> files;
+	uintmax_t totalSize = 0;
+	std::error_code error;
+
+	for (const auto& item : std::filesystem::directory_iterator(directory, error)) {
+		// Files still being written are hidden until they are renamed into place.
+		if (!item.is_regular_file(error) || item.path().filename().string().starts_with('.')) {
+			continue;
+		}
+
+		files.push_back({item.path(), item.last_write_time(error), item.file_size(error)});
+		totalSize += files.back().size;
+	}
+
+	std::ranges::sort(files, {}, &CacheFile::modified);
+
+	for (const CacheFile& file : files) {
+		if (totalSize <= m_diskCap) {
+			break;
+		}
+
+		std::filesystem::remove(file.path, error);
+		totalSize -= file.size;
+	}
+}
+
+std::filesystem::path MeshCache::GetDirectory() const
+{
+	std::lock_guard lock(m_mutex);
+
+	return m_directory;
+}
\ No newline at end of file
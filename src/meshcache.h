@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "declarations/config.h"
+#include "declarations/structures.h"
+#include "exporter/progress.h"
+
+// A content addressed cache on disk of compiled meshes and the files exported from them. Entries are named by a hash of
+// the source pixels and every setting that affects the geometry, so identical requests share entries whichever file
+// the image came from. The directory is capped in size, the least recently used entries are removed first. All public
+// functions are safe to call from multiple threads.
+class MeshCache {
+public:
+	explicit MeshCache(uint64_t diskCap);
+	// A background store in flight is cancelled and waited for, so its partial file is always removed.
+	~MeshCache();
+
+	MeshCache(const MeshCache&) = delete;
+	MeshCache& operator=(const MeshCache&) = delete;
+
+	// Keep entries in a subdirectory of the cache directory, an empty path disables the cache.
+	void SetCacheDirectory(const std::filesystem::path& cacheDirectory);
+
+	// Load the mesh compiled with these settings, skipping the depth map and compile.
+	bool LoadModel(const MeshSettings& settings, Model& model);
+	// Write the mesh to the cache, which may take a while for a large one. The progress can cancel it.
+	void StoreModel(const Model& model, ExportProgress& progress);
+	// Write the mesh to the cache on a worker of its own, so neither the interface nor exports wait for it. The model
+	// is read in place rather than copied, so CancelStore must be called before it changes.
+	void StartStore(const Model& model);
+	// Stop a background store and wait for it, which takes no longer than writing a single block of the mesh.
+	void CancelStore();
+
+	// Copy a previous export of the mesh compiled with these settings to the file path, in the format of its extension.
+	bool LoadExport(const MeshSettings& settings, const char* filePath, bool ascii, bool optimize);
+	// Keep a copy of a finished export of the model.
+	void StoreExport(const MeshSettings& settings, const char* filePath, bool ascii, bool optimize);
+
+	// Find the settings an unchanged source file was last compiled with under this configuration, so its cached mesh
+	// and exports can be found without decoding it. The source key is the identity given by BuildImageKey.
+	bool LookupSource(const std::string& sourceKey, const Config* config, MeshSettings& settings);
+	void StoreSource(const std::string& sourceKey, const Config* config, const MeshSettings& settings);
+
+	// A summary of the hits and misses of each kind of lookup since startup.
+	[[nodiscard]] std::string GetStats() const;
+private:
+	// Counts the outcome of one kind of lookup.
+	struct Counter {
+		std::atomic<uint64_t> hits = 0;
+		std::atomic<uint64_t> misses = 0;
+
+		bool Record(bool hit);
+	};
+
+	// Find an entry by its file name, marking it as the most recently used. Empty if it does not exist.
+	[[nodiscard]] std::filesystem::path Find(const std::string& name) const;
+	// Remove the least recently used entries until the directory fits within the cap.
+	void Trim() const;
+
+	[[nodiscard]] std::filesystem::path GetDirectory() const;
+
+	std::filesystem::path m_directory;
+	mutable std::mutex m_mutex;
+	uint64_t m_diskCap = 0;
+
+	Counter m_models;
+	Counter m_exports;
+	Counter m_sources;
+
+	// The progress of the background store, shared with its worker so it can be cancelled.
+	std::shared_ptr<ExportProgress> m_storeProgress;
+	std::jthread m_storeThread;
+};
\ No newline at end of file
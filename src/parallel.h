@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Split the range [0, count) into one contiguous block per hardware thread and call function(begin, end) for each
+// block in parallel, returning once every block has finished. Small ranges are run on the calling thread.
+template <typename Function>
+void ParallelFor(const size_t count, const Function& function, const size_t minBlockSize = 1)
+{
+	const size_t hardwareThreads = std::max(1U, std::thread::hardware_concurrency());
+	const size_t blockLimit = std::max<size_t>(1, count / std::max<size_t>(1, minBlockSize));
+	const size_t threadCount = std::min(hardwareThreads, blockLimit);
+
+	if (threadCount <= 1) {
+		if (count > 0) {
+			function(size_t{0}, count);
+		}
+
+		return;
+	}
+
+	std::vector<std::jthread> threads;
+	threads.reserve(threadCount - 1);
+
+	const size_t blockSize = count / threadCount;
+	const size_t remainder = count % threadCount;
+	size_t begin = 0;
+
+	for (size_t thread = 0; thread < threadCount; thread++) {
+		// Spread the remainder across the first blocks so they differ in size by at most one.
+		const size_t end = begin + blockSize + (thread < remainder ? 1 : 0);
+
+		if (thread == threadCount - 1) {
+			function(begin, end); // The calling thread takes the last block rather than idling.
+		} else {
+			threads.emplace_back([&function, begin, end] { function(begin, end); });
+		}
+
+		begin = end;
+	}
+}
\ No newline at end of file
@@ -1,106 +1,401 @@
 // SPDX-License-Identifier: GPL-3.0
 #include "entity.h"
 #include <algorithm>
+#include <array>
 #include <battery/embed.hpp>
-#include <climits>
-#include <cstring>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
 #include <glad/gl.h>
+#include <glm/common.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/mat4x4.hpp>
 #include <glm/vec3.hpp>
 #include <iostream>
+#include <utility>
+#include <vector>
+#include "../declarations/constants.h"
 #include "../declarations/structures.h"
+#include "../parallel.h"
+#include "../vertexorder.h"
+#include "shadercache.h"
 
-// Shader initialization functions.
+// The most times a proxy mesh is clustered again with larger cells to bring it under its triangle limit.
+constexpr int PROXY_MESH_PASSES = 6;
 
-GLuint LoadShader(const char* pFileContent, const GLenum shaderType)
+// Reorder the triangles and vertices of every chunk for the vertex cache, in parallel as chunks share nothing. The grid
+// order of the compiler walks whole rows, so on wide images a vertex has long left the cache when the next row reuses
+// it, and the back and walls are interleaved with the front. The vertices of the chunks end at vertexEnd.
+void OptimizePreviewMesh(PreviewMesh& mesh, const PreviewChunks& chunks, const size_t vertexEnd, const char* subject)
 {
-	const GLuint shader = glCreateShader(shaderType);
+	const auto startTime = std::chrono::high_resolution_clock::now();
 
-	if (shader == 0) {
-		std::cout << "Error creating shader type!\n";
-		exit(1);
+	std::vector<VertexCacheStats> before(chunks.counts.size());
+	std::vector<VertexCacheStats> after(chunks.counts.size());
+
+	ParallelFor(chunks.counts.size(), [&](const size_t begin, const size_t end) {
+		std::vector<uint32_t> order;
+		std::vector<PreviewVertex> reordered;
+
+		for (size_t chunk = begin; chunk < end; chunk++) {
+			const size_t firstIndex = reinterpret_cast<size_t>(chunks.offsets[chunk]) / sizeof(uint16_t);
+			uint16_t* indices = mesh.indices.data() + firstIndex;
+			const size_t indexCount = chunks.counts[chunk];
+			PreviewVertex* vertices = mesh.vertices.data() + chunks.baseVertices[chunk];
+			const size_t vertexCount =
+				(chunk + 1 < chunks.counts.size() ? chunks.baseVertices[chunk + 1] : vertexEnd) -
+				chunks.baseVertices[chunk];
+
+			before[chunk] = AnalyzeVertexCache(indices, indexCount, vertexCount);
+
+			OptimizeVertexCache(indices, indexCount, vertexCount);
+			OptimizeVertexFetch(indices, indexCount, vertexCount, order);
+
+			reordered.resize(vertexCount);
+
+			for (size_t vertex = 0; vertex < vertexCount; vertex++) {
+				reordered[vertex] = vertices[order[vertex]];
+			}
+
+			std::ranges::copy(reordered, vertices);
+
+			after[chunk] = AnalyzeVertexCache(indices, indexCount, vertexCount);
+		}
+	});
+
+	VertexCacheStats totalBefore;
+	VertexCacheStats totalAfter;
+
+	for (size_t chunk = 0; chunk < chunks.counts.size(); chunk++) {
+		totalBefore += before[chunk];
+		totalAfter += after[chunk];
 	}
 
-	const char* shaders[1] = {pFileContent};
-	const size_t length = strlen(pFileContent);
+	const std::chrono::duration<double, std::milli> elapsedTime =
+		std::chrono::high_resolution_clock::now() - startTime;
 
-	if (length > INT_MAX) {
-		std::cout << "Shader file \"" << shaderType << "\" too large!\n";
-		exit(1);
+	ReportVertexOrder(subject, totalBefore, totalAfter, elapsedTime.count());
+}
+
+// Merge the vertices of a mesh within each cubic cell of the given size into one at their mean position, dropping the
+// triangles left with fewer than three corners. The scratch space holds the cluster of each vertex.
+void ClusterVertices(const Model& model, const glm::vec3& minimum, const float cellSize, Model& proxy,
+                     std::vector<uint32_t>& scratch)
+{
+	// An open addressing table from the key of each occupied cell to its merged vertex, grown to stay half empty.
+	constexpr uint64_t emptyKey = UINT64_MAX;
+	std::vector<uint64_t> tableKeys(1024, emptyKey);
+	std::vector<uint32_t> tableVertices(1024, 0);
+
+	const auto slotOf = [](const uint64_t key, const std::vector<uint64_t>& keys) {
+		const size_t mask = keys.size() - 1;
+		size_t slot = (key * 0x9E3779B97F4A7C15ULL >> 32) & mask;
+
+		while (keys[slot] != emptyKey && keys[slot] != key) {
+			slot = (slot + 1) & mask;
+		}
+
+		return slot;
+	};
+
+	std::vector<glm::vec3> sums;
+	std::vector<uint32_t> members;
+	std::vector<uint32_t> fronts;
+	const size_t triangleCount = model.indices.size() / 3;
+	std::vector<uint32_t>& vertexCluster = scratch;
+	vertexCluster.resize(model.vertices.size());
+
+	for (size_t vertex = 0; vertex < model.vertices.size(); vertex++) {
+		const glm::vec3 cell = (model.vertices[vertex].position - minimum) / cellSize;
+		const uint64_t key = static_cast<uint64_t>(cell.x) | static_cast<uint64_t>(cell.y) << 21 |
+		                     static_cast<uint64_t>(cell.z) << 42;
+
+		size_t slot = slotOf(key, tableKeys);
+
+		if (tableKeys[slot] == emptyKey) {
+			if ((sums.size() + 1) * 2 > tableKeys.size()) {
+				std::vector<uint64_t> keys(tableKeys.size() * 2, emptyKey);
+				std::vector<uint32_t> vertices(tableKeys.size() * 2, 0);
+
+				for (size_t old = 0; old < tableKeys.size(); old++) {
+					if (tableKeys[old] != emptyKey) {
+						const size_t moved = slotOf(tableKeys[old], keys);
+						keys[moved] = tableKeys[old];
+						vertices[moved] = tableVertices[old];
+					}
+				}
+
+				tableKeys = std::move(keys);
+				tableVertices = std::move(vertices);
+				slot = slotOf(key, tableKeys);
+			}
+
+			tableKeys[slot] = key;
+			tableVertices[slot] = static_cast<uint32_t>(sums.size());
+			sums.emplace_back(0.0F);
+			members.push_back(0);
+			fronts.push_back(0);
+		}
+
+		const uint32_t cluster = tableVertices[slot];
+		vertexCluster[vertex] = cluster;
+		sums[cluster] += model.vertices[vertex].position;
+		members[cluster]++;
+		fronts[cluster] += model.vertices[vertex].color.r > 0.0F ? 1 : 0;
 	}
 
-	const GLint lengths[1] = {static_cast<GLint>(length)};
+	proxy.vertices.resize(sums.size());
+	proxy.indices.clear();
 
-	GLint success = 0;
+	for (size_t cluster = 0; cluster < sums.size(); cluster++) {
+		// Only the flag of the front is kept by the preview, so the colour just records which side most members are on.
+		const glm::vec3 color(fronts[cluster] * 2 > members[cluster] ? 1.0F : 0.0F);
+		proxy.vertices[cluster] = Vertex(sums[cluster] / static_cast<float>(members[cluster]), color);
+	}
 
-	glShaderSource(shader, 1, shaders, lengths);
-	glCompileShader(shader);
-	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+	// Triangles are remapped in blocks in parallel. Each starts from its lowest corner, keeping its winding, so the
+	// copies that merging leaves on noisy surfaces are identical and can be dropped.
+	using Triangle = std::array<uint32_t, 3>;
 
-	if (success == 0) {
-		char infoLog[512];
-		glGetShaderInfoLog(shader, 512, nullptr, infoLog);
-		std::cout << "Failed to compile shader type \"" << shaderType << "\":\n" << infoLog << '\n';
-		exit(1);
+	constexpr size_t blockTriangles = 1 << 18;
+	const size_t blockCount = (triangleCount + blockTriangles - 1) / blockTriangles;
+	std::vector<std::vector<Triangle>> blockTriangleLists(blockCount);
+
+	ParallelFor(blockCount, [&](const size_t begin, const size_t end) {
+		for (size_t block = begin; block < end; block++) {
+			const size_t last = std::min((block + 1) * blockTriangles, triangleCount);
+
+			for (size_t triangle = block * blockTriangles; triangle < last; triangle++) {
+				Triangle corners = {vertexCluster[model.indices[triangle * 3]],
+				                    vertexCluster[model.indices[triangle * 3 + 1]],
+				                    vertexCluster[model.indices[triangle * 3 + 2]]};
+
+				if (corners[0] == corners[1] || corners[1] == corners[2] || corners[2] == corners[0]) {
+					continue;
+				}
+
+				std::ranges::rotate(corners, std::ranges::min_element(corners));
+				blockTriangleLists[block].push_back(corners);
+			}
+		}
+	});
+
+	std::vector<Triangle> triangles;
+
+	for (std::vector<Triangle>& list : blockTriangleLists) {
+		triangles.insert(triangles.end(), list.begin(), list.end());
+		list = std::vector<Triangle>();
 	}
 
-	return shader;
+	std::ranges::sort(triangles);
+	triangles.erase(std::ranges::unique(triangles).begin(), triangles.end());
+
+	proxy.indices.reserve(triangles.size() * 3);
+
+	for (const Triangle& triangle : triangles) {
+		proxy.indices.insert(proxy.indices.end(), triangle.begin(), triangle.end());
+	}
 }
 
-GLuint InitShaders()
+// Simplify a mesh to at most PROXY_MESH_TRIANGLES by vertex clustering (Rossignac and Borrel 1993). The first cell size
+// comes from the average spacing of the vertices over the bounds, which underestimates the surface of a height field
+// with strong relief, so the cells are enlarged until the result fits. Returns false if the mesh is small enough to
+// draw whole.
+bool BuildProxyModel(const Model& model, const glm::vec3& minimum, const glm::vec3& maximum, Model& proxy)
 {
-	const GLuint shaderProgram = glCreateProgram();
+	const auto startTime = std::chrono::high_resolution_clock::now();
 
-	if (shaderProgram == 0) {
-		std::cout << "Error creating shader program!\n";
-		exit(1);
+	const size_t triangleCount = model.indices.size() / 3;
+
+	if (triangleCount <= PROXY_MESH_TRIANGLES || model.vertices.empty()) {
+		return false;
 	}
 
-	const GLuint vertShader = LoadShader(b::embed<"res/shaders/vertex.glsl">().data(), GL_VERTEX_SHADER);
-	const GLuint fragShader = LoadShader(b::embed<"res/shaders/fragment.glsl">().data(), GL_FRAGMENT_SHADER);
+	// Estimate the spacing from the area of the two largest sides of the bounds, which the front and back cover for a
+	// lithophane, then widen it by the linear factor the triangle count has to shrink by.
+	glm::vec3 extent = maximum - minimum;
+	std::sort(&extent[0], &extent[0] + 3);
 
-	// Attach the finalised shaders to a shader program to be used by the rest of the program.
-	glAttachShader(shaderProgram, vertShader);
-	glAttachShader(shaderProgram, fragShader);
+	const double area = std::max(static_cast<double>(extent[1]) * extent[2], static_cast<double>(extent[2]) * 1e-3);
+	const double spacing = std::sqrt(area * 2.0 / static_cast<double>(model.vertices.size()));
+	const double reduction = std::sqrt(static_cast<double>(triangleCount) / PROXY_MESH_TRIANGLES);
 
-	GLint success = 0;
+	// Each cell coordinate is packed into 21 bits of the key.
+	constexpr uint64_t cellLimit = 1 << 21;
+	double cellSize = std::max(spacing * reduction, extent[2] / (cellLimit - 1.0));
 
-	glLinkProgram(shaderProgram);
-	glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+	std::vector<uint32_t> scratch;
+	int passes = 0;
 
-	if (success == 0) {
-		char infoLog[512];
-		glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
-		std::cout << "Failed to link shader program:\n" << infoLog << '\n';
-		exit(1);
+	while (true) {
+		ClusterVertices(model, minimum, static_cast<float>(cellSize), proxy, scratch);
+		passes++;
+
+		const size_t proxyTriangles = proxy.indices.size() / 3;
+
+		if (proxyTriangles <= PROXY_MESH_TRIANGLES || passes == PROXY_MESH_PASSES) {
+			break;
+		}
+
+		// Relief makes the count fall faster than the square of the cell size, the margin avoids a pass that only
+		// just misses.
+		cellSize *= std::sqrt(static_cast<double>(proxyTriangles) / PROXY_MESH_TRIANGLES) * 1.05;
 	}
 
-	glValidateProgram(shaderProgram);
-	glGetProgramiv(shaderProgram, GL_VALIDATE_STATUS, &success);
+	const std::chrono::duration<double, std::milli> elapsedTime =
+		std::chrono::high_resolution_clock::now() - startTime;
 
-	if (success == 0) {
-		char infoLog[512];
-		glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
-		std::cout << "Failed to validate shader program:\n" << infoLog << '\n';
-		exit(1);
+	std::cout << "Proxy mesh of " << proxy.indices.size() / 3 << " triangles built in " << passes << " passes in "
+	          << elapsedTime.count() << "ms\n";
+
+	return true;
+}
+
+// Convert a vertex to the compact preview format, quantised across the bounds of the mesh.
+PreviewVertex QuantisePreviewVertex(const Vertex& vertex, const PreviewMesh& mesh)
+{
+	PreviewVertex quantised;
+
+	for (int axis = 0; axis < 3; axis++) {
+		const float steps = mesh.scale[axis] > 0.0F ? (vertex.position[axis] - mesh.offset[axis]) / mesh.scale[axis]
+		                                            : 0.0F;
+		quantised.position[axis] = static_cast<uint16_t>(std::clamp(steps + 0.5F, 0.0F, 65535.0F));
+	}
+
+	// The back is black, as is any front vertex at the full depth, so the flag alone reproduces both.
+	quantised.front = vertex.color.r > 0.0F ? 1 : 0;
+
+	return quantised;
+}
+
+// Append a model to a preview mesh as a run of chunks. Triangles are taken in order and a new chunk is started whenever
+// the next one would not fit, a vertex used by several chunks is stored once in each. The compiled mesh builds its
+// triangles row by row, so only the vertices along the rows where chunks meet are repeated.
+void AppendPreviewChunks(const Model& model, PreviewMesh& mesh, PreviewChunks& chunks)
+{
+	constexpr uint32_t chunkVertexLimit = UINT16_MAX + 1;
+
+	// The chunk each vertex was last stored in and its index there.
+	std::vector<uint32_t> vertexChunk(model.vertices.size(), UINT32_MAX);
+	std::vector<uint16_t> localIndex(model.vertices.size(), 0);
+
+	uint32_t chunk = 0;
+	uint32_t chunkVertices = 0;
+	size_t chunkStart = mesh.indices.size();
+
+	const auto closeChunk = [&] {
+		if (mesh.indices.size() > chunkStart) {
+			chunks.counts.push_back(static_cast<GLsizei>(mesh.indices.size() - chunkStart));
+			chunks.offsets.push_back(reinterpret_cast<const void*>(chunkStart * sizeof(uint16_t)));
+			chunks.baseVertices.push_back(static_cast<GLint>(mesh.vertices.size() - chunkVertices));
+		}
+	};
+
+	for (size_t index = 0; index + 2 < model.indices.size(); index += 3) {
+		uint32_t missing = 0;
+
+		for (size_t corner = 0; corner < 3; corner++) {
+			missing += vertexChunk[model.indices[index + corner]] != chunk ? 1 : 0;
+		}
+
+		if (chunkVertices + missing > chunkVertexLimit) {
+			closeChunk();
+			chunk++;
+			chunkVertices = 0;
+			chunkStart = mesh.indices.size();
+		}
+
+		for (size_t corner = 0; corner < 3; corner++) {
+			const uint32_t vertex = model.indices[index + corner];
+
+			if (vertexChunk[vertex] != chunk) {
+				vertexChunk[vertex] = chunk;
+				localIndex[vertex] = static_cast<uint16_t>(chunkVertices++);
+				mesh.vertices.push_back(QuantisePreviewVertex(model.vertices[vertex], mesh));
+			}
+
+			mesh.indices.push_back(localIndex[vertex]);
+		}
+	}
+
+	closeChunk();
+}
+
+// Convert a mesh into the compact preview format, followed by its proxy if it is large.
+void BuildPreviewMesh(const Model& model, PreviewMesh& mesh)
+{
+	glm::vec3 minimum(0.0F);
+	glm::vec3 maximum(0.0F);
+
+	if (!model.vertices.empty()) {
+		minimum = maximum = model.vertices.front().position;
+	}
+
+	for (const Vertex& vertex : model.vertices) {
+		minimum = glm::min(minimum, vertex.position);
+		maximum = glm::max(maximum, vertex.position);
+	}
+
+	mesh.offset = minimum;
+	mesh.scale = (maximum - minimum) / static_cast<float>(UINT16_MAX);
+
+	// The front is shaded from its depth within the thickness, a flat model is left white.
+	const float depthMax = model.settings.thickMax - model.settings.thickMin;
+	mesh.depthMax = depthMax > 0.0F ? depthMax : 1.0F;
+
+	Model proxy;
+	const bool hasProxy = BuildProxyModel(model, minimum, maximum, proxy);
+
+	mesh.vertices.reserve(model.vertices.size() + proxy.vertices.size());
+	mesh.indices.reserve(model.indices.size() + proxy.indices.size());
+
+	AppendPreviewChunks(model, mesh, mesh.chunks);
+	OptimizePreviewMesh(mesh, mesh.chunks, mesh.vertices.size(), "Preview");
+
+	if (hasProxy) {
+		AppendPreviewChunks(proxy, mesh, mesh.proxy);
+		OptimizePreviewMesh(mesh, mesh.proxy, mesh.vertices.size(), "Proxy");
+	}
+}
+
+void Entity::InitShaders(const std::filesystem::path& cacheDirectory)
+{
+	if (m_shader.program.IsValid()) {
+		return;
 	}
 
-	glUseProgram(shaderProgram);
+	ShaderSources sources;
+	sources.vertex = b::embed<"res/shaders/vertex.glsl">().data();
+	sources.fragment = b::embed<"res/shaders/fragment.glsl">().data();
 
-	// Clean up shaders now they are inside the shader program.
-	glDeleteShader(vertShader);
-	glDeleteShader(fragShader);
+	// The wireframe variant passes each triangle through a geometry shader that adds barycentric coordinates, so the
+	// fragment shader can draw its edges over the surface.
+	ShaderSources wireframeSources = sources;
+	wireframeSources.geometry = b::embed<"res/shaders/wireframe_geometry.glsl">().data();
+	wireframeSources.fragment = b::embed<"res/shaders/wireframe_fragment.glsl">().data();
 
-	return shaderProgram;
+	if (!BuildShader(m_shader, sources, cacheDirectory) ||
+	    !BuildShader(m_wireframeShader, wireframeSources, cacheDirectory)) {
+		exit(1);
+	}
 }
 
-Entity::Entity(const Model& model)
+bool Entity::BuildShader(Shader& shader, const ShaderSources& sources, const std::filesystem::path& cacheDirectory)
 {
-	LoadModel(model);
+	if (!BuildCachedProgram(shader.program, sources, cacheDirectory)) {
+		return false;
+	}
+
+	shader.mvpLoc = shader.program.GetUniformLocation("mvp");
+	shader.offsetLoc = shader.program.GetUniformLocation("quant_offset");
+	shader.scaleLoc = shader.program.GetUniformLocation("quant_scale");
+	shader.depthMaxLoc = shader.program.GetUniformLocation("depth_max");
+
+	return true;
 }
 
-void Entity::Draw(glm::mat4 mvp) const
+void Entity::Draw(glm::mat4 mvp, const bool wireframe, const bool proxy) const
 {
 	// Apply translation / position to the matrix.
 	mvp = glm::translate(mvp, glm::vec3(m_position.x, m_position.y, m_position.z));
@@ -113,14 +408,25 @@ void Entity::Draw(glm::mat4 mvp) const
 	// Apply scale to the matrix.
 	mvp = glm::scale(mvp, glm::vec3(m_scale.x, m_scale.y, m_scale.z));
 
+	const Shader& shader = wireframe ? m_wireframeShader : m_shader;
+
 	// Pass the completed matrix to the GPU to be applied in the shader to the vector position.
-	glUniformMatrix4fv(m_mvpLoc, 1, GL_FALSE, &mvp[0][0]);
+	shader.program.Use();
+	glUniformMatrix4fv(shader.mvpLoc, 1, GL_FALSE, &mvp[0][0]);
+
+	// Pass how to turn the quantised positions back into millimetres.
+	glUniform3fv(shader.offsetLoc, 1, &m_mesh.offset[0]);
+	glUniform3fv(shader.scaleLoc, 1, &m_mesh.scale[0]);
+	glUniform1f(shader.depthMaxLoc, m_mesh.depthMax);
 
 	// Bind the VAO referencing the vertex and indices buffers.
-	glBindVertexArray(m_vao);
+	m_vertexArray.Bind();
+
+	const PreviewChunks& chunks = proxy && !m_mesh.proxy.counts.empty() ? m_mesh.proxy : m_mesh.chunks;
 
-	// Draw the given data to the screen.
-	glDrawElements(GL_TRIANGLES, m_indicesCount, GL_UNSIGNED_INT, nullptr);
+	// Draw every chunk of the mesh to the screen in one call.
+	glMultiDrawElementsBaseVertex(GL_TRIANGLES, chunks.counts.data(), GL_UNSIGNED_SHORT, chunks.offsets.data(),
+	                              static_cast<GLsizei>(chunks.counts.size()), chunks.baseVertices.data());
 
 	// Unbind the VAO to ensure a clear OpenGL state.
 	glBindVertexArray(0);
@@ -128,50 +434,144 @@ void Entity::Draw(glm::mat4 mvp) const
 
 void Entity::LoadModel(const Model& model)
 {
-	const GLuint shaderProgram = InitShaders();
+	InitShaders();
+
+	// The vertex array and its buffers are kept between models, the new mesh is written into the spare buffers while
+	// the previous one is still drawn from the current ones.
+	m_vertexArray.Create();
+
+	// A conversion still in progress is finished first, its result is dropped along with any upload of an older mesh.
+	m_builder = std::jthread();
+	m_upload = Upload();
+
+	auto build = std::make_shared<Build>();
+	m_build = build;
+
+	// Converting and reordering a large mesh takes seconds, far beyond the frame budget the upload keeps to.
+	m_builder = std::jthread([build, &model] {
+		BuildPreviewMesh(model, build->mesh);
+		build->finished = true;
+	});
+}
+
+void Entity::StartUpload(PreviewMesh&& mesh)
+{
+	m_upload = Upload();
+	m_upload.mesh = std::move(mesh);
 
-	// Clear out the previous model if it exists.
-	if (HasModel()) {
-		glDeleteVertexArrays(1, &m_vao);
+	const size_t vertexSize = m_upload.mesh.vertices.size() * sizeof(PreviewVertex);
+	const size_t indexSize = m_upload.mesh.indices.size() * sizeof(uint16_t);
+
+	if (!m_vertexBuffer.BeginWrite(vertexSize) || !m_indexBuffer.BeginWrite(indexSize)) {
+		std::cout << "Failed to upload the mesh!\n";
+		m_upload = Upload();
+		return;
+	}
+
+	m_upload.active = true;
+
+	if (!m_vertexBuffer.IsSpareMapped() || !m_indexBuffer.IsSpareMapped()) {
+		return;
 	}
 
-	m_mvpLoc = glGetUniformLocation(shaderProgram, "mvp");
-	m_indicesCount = model.indices.size();
+	// Mapped buffers are filled on the worker, so even the largest mesh costs the frames nothing but the swap. The
+	// previous conversion has finished, assigning the copy joins it.
+	auto copied = std::make_shared<std::atomic<bool>>(false);
+	m_upload.copied = copied;
+
+	m_builder = std::jthread([this, copied] {
+		const PreviewMesh& mesh = m_upload.mesh;
+
+		m_vertexBuffer.Write(0, mesh.vertices.data(), mesh.vertices.size() * sizeof(PreviewVertex));
+		m_indexBuffer.Write(0, mesh.indices.data(), mesh.indices.size() * sizeof(uint16_t));
+		*copied = true;
+	});
+}
+
+bool Entity::WriteUpload()
+{
+	const auto startTime = std::chrono::high_resolution_clock::now();
+
+	const auto* vertices = reinterpret_cast<const unsigned char*>(m_upload.mesh.vertices.data());
+	const auto* indices = reinterpret_cast<const unsigned char*>(m_upload.mesh.indices.data());
+	const size_t vertexSize = m_upload.mesh.vertices.size() * sizeof(PreviewVertex);
+	const size_t indexSize = m_upload.mesh.indices.size() * sizeof(uint16_t);
+	const size_t totalSize = vertexSize + indexSize;
+
+	// At least one piece is written every frame, so an upload always makes progress.
+	do {
+		const bool writingVertices = m_upload.written < vertexSize;
+		const size_t offset = writingVertices ? m_upload.written : m_upload.written - vertexSize;
+		const size_t size = std::min<size_t>(MESH_UPLOAD_CHUNK_SIZE,
+		                                     (writingVertices ? vertexSize : indexSize) - offset);
+
+		if (writingVertices) {
+			m_vertexBuffer.Write(offset, vertices + offset, size);
+		} else if (size > 0) {
+			m_indexBuffer.Write(offset, indices + offset, size);
+		}
+
+		m_upload.written += size;
+	} while (m_upload.written < totalSize &&
+	         std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count() <
+	             MESH_UPLOAD_FRAME_BUDGET);
+
+	return m_upload.written == totalSize;
+}
 
-	glGenVertexArrays(1, &m_vao);
-	glBindVertexArray(m_vao);
+void Entity::ContinueUpload()
+{
+	if (m_build != nullptr) {
+		if (!m_build->finished) {
+			return;
+		}
+
+		// The worker has finished with the model and the mesh.
+		StartUpload(std::move(m_build->mesh));
+		m_build = nullptr;
+	}
 
-	// Allocate, configure and bind the buffers.
-	GLuint VBO = 0;
-	GLuint IBO = 0;
+	if (!m_upload.active) {
+		return;
+	}
 
-	glGenBuffers(1, &VBO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(model.vertices.size() * sizeof(Vertex)),
-	             model.vertices.data(), GL_STATIC_DRAW);
+	// Without mapped buffers the mesh is written through the driver here, a piece every frame.
+	if (m_upload.copied != nullptr ? !*m_upload.copied : !WriteUpload()) {
+		return;
+	}
 
-	glGenBuffers(1, &IBO);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(model.indices.size() * sizeof(uint32_t)),
-	             model.indices.data(), GL_STATIC_DRAW);
+	// Swap the new mesh in at once, between two frames.
+	m_vertexArray.Bind();
+	m_vertexBuffer.EndWrite();
+	m_indexBuffer.EndWrite();
 
-	// Tell the driver how to read position from the buffer.
+	// Tell the driver how to read the quantised position and the front flag from the buffer, as whole numbers.
 	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), nullptr);
+	glVertexAttribPointer(0, 4, GL_UNSIGNED_SHORT, GL_FALSE, sizeof(PreviewVertex), nullptr);
 
-	// Tell the driver how to read color from the buffer.
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(sizeof(glm::vec3)));
+	// Colour is no longer read from the buffer, it is derived in the shader.
+	glDisableVertexAttribArray(1);
 
 	// Unbind.
 	glBindVertexArray(0);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	// Only the chunks and quantisation are needed to draw, the arrays now live on the GPU.
+	m_mesh = std::move(m_upload.mesh);
+	m_mesh.vertices = std::vector<PreviewVertex>();
+	m_mesh.indices = std::vector<uint16_t>();
+	m_upload = Upload();
 }
 
 bool Entity::HasModel() const
 {
-	return m_vao != 0;
+	return m_vertexArray.IsValid();
+}
+
+bool Entity::IsUploading() const
+{
+	return m_build != nullptr || m_upload.active;
 }
 
 void Entity::SetPosition(const glm::vec3& position)
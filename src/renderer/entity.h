@@ -1,18 +1,71 @@
 // SPDX-License-Identifier: GPL-3.0
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <glad/gl.h>
 #include <glm/mat4x4.hpp>
 #include <glm/vec3.hpp>
+#include <memory>
+#include <thread>
+#include <vector>
 #include "../declarations/structures.h"
+#include "resources.h"
+
+// A vertex as the preview draws it, a third of the size of a Vertex. The position is quantised to 16 bit steps across
+// the bounds of the mesh and the colour is left to the shader, which shades the front by its depth.
+struct PreviewVertex {
+	uint16_t position[3];
+	uint16_t front; // One on the front and zero on the back, blending between the two along the walls.
+};
+
+// A run of chunks of a preview mesh drawn together, one entry per chunk in the form glMultiDrawElementsBaseVertex takes
+// them.
+struct PreviewChunks {
+	std::vector<GLsizei> counts;
+	std::vector<const void*> offsets;
+	std::vector<GLint> baseVertices;
+};
+
+// A mesh in the compact format of the preview. It is split into chunks of at most 65536 vertices so every index fits
+// in 16 bits, each chunk counting its indices from its own first vertex.
+struct PreviewMesh {
+	std::vector<PreviewVertex> vertices;
+	std::vector<uint16_t> indices;
+
+	PreviewChunks chunks;
+	// A simplified copy of a large mesh drawn while the camera moves, stored after the full mesh in the same arrays.
+	// Empty when the mesh is small enough to always be drawn whole.
+	PreviewChunks proxy;
+
+	// Reverses the quantisation, a position is the offset plus its steps times the scale.
+	glm::vec3 offset = glm::vec3(0.0F);
+	glm::vec3 scale = glm::vec3(0.0F);
+	float depthMax = 1.0F;
+};
 
 class Entity {
 public:
 	Entity() = default;
-	explicit Entity(const Model& model);
-	void Draw(glm::mat4 mvp) const;
+	// Draw the mesh, with its edges over the surface when wireframe is set. When proxy is set a large mesh is drawn
+	// simplified instead.
+	void Draw(glm::mat4 mvp, bool wireframe, bool proxy) const;
+
+	// Build the shader programs the entity is drawn with, only the first call does any work. Binaries of the programs
+	// are kept in the cache directory to skip compiling them on the next start.
+	void InitShaders(const std::filesystem::path& cacheDirectory = {});
 
+	// Start loading a mesh, the previous one stays on screen until the new one is fully on the GPU. The mesh is
+	// converted to the compact preview format on a worker thread, reading the model in place, so it must not change
+	// until IsUploading returns false.
 	void LoadModel(const Model& model);
+	// Start uploading a mesh once its conversion has finished and swap it in once complete. Mapped buffers are filled
+	// on the worker, otherwise as much is written each frame as fits the frame budget. Called every frame.
+	void ContinueUpload();
 	[[nodiscard]] bool HasModel() const;
+	[[nodiscard]] bool IsUploading() const;
 
 	void SetPosition(const glm::vec3& position);
 	void SetRotation(const glm::vec3& rotation);
@@ -24,7 +77,49 @@ class Entity {
 	glm::vec3 m_rotation = glm::vec3(0.0F, 0.0F, 0.0F);
 	glm::vec3 m_scale = glm::vec3(1.0F, 1.0F, 1.0F);
 
-	unsigned int m_vao = 0;
-	int m_mvpLoc = 0;
-	size_t m_indicesCount = 0;
+	// A program the entity is drawn with and the locations of its uniforms.
+	struct Shader {
+		ShaderProgram program;
+		int mvpLoc = 0;
+		int offsetLoc = 0;
+		int scaleLoc = 0;
+		int depthMaxLoc = 0;
+	};
+
+	static bool BuildShader(Shader& shader, const ShaderSources& sources, const std::filesystem::path& cacheDirectory);
+
+	Shader m_shader;
+	Shader m_wireframeShader;
+	VertexArray m_vertexArray;
+	StreamingBuffer m_vertexBuffer = StreamingBuffer(GL_ARRAY_BUFFER);
+	StreamingBuffer m_indexBuffer = StreamingBuffer(GL_ELEMENT_ARRAY_BUFFER);
+
+	// The chunks and quantisation of the mesh on screen, its arrays are released once on the GPU.
+	PreviewMesh m_mesh;
+
+	// A mesh being converted to the preview format, shared with the worker converting it.
+	struct Build {
+		PreviewMesh mesh;
+		std::atomic<bool> finished = false;
+	};
+
+	// The mesh being uploaded, its vertices are written first then its indices.
+	struct Upload {
+		PreviewMesh mesh;
+		size_t written = 0;
+		bool active = false;
+		// Set while the worker fills mapped buffers with the whole mesh, and once it has finished.
+		std::shared_ptr<std::atomic<bool>> copied;
+	};
+
+	// Claim buffer space for a converted mesh and start writing it.
+	void StartUpload(PreviewMesh&& mesh);
+	// Write as much of the upload as fits the frame budget, returning true once all of it is written.
+	bool WriteUpload();
+
+	std::shared_ptr<Build> m_build;
+	Upload m_upload;
+
+	// Declared last so it is joined before the state it uses is destroyed.
+	std::jthread m_builder;
 };
\ No newline at end of file
@@ -0,0 +1,288 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "heightfield.h"
+#include <algorithm>
+#include <battery/embed.hpp>
+#include <cstdint>
+#include <glad/gl.h>
+#include <glm/vec3.hpp>
+#include <iostream>
+#include "../declarations/constants.h"
+#include "../parallel.h"
+#include "shadercache.h"
+
+// The texels along each side of a patch, the most every implementation can tessellate an edge into.
+constexpr int HEIGHT_FIELD_PATCH_TEXELS = 64;
+
+// Convert a depth map into 16 bit texels, box filtering it down by an integer factor. Depth is stored negated, from
+// zero at the top of the front to the largest value at its deepest point.
+void EncodeDepthTexels(const std::vector<float>& depthMap, const int width, const int height, const int factor,
+                       std::vector<uint16_t>& texels)
+{
+	const int textureWidth = (width + factor - 1) / factor;
+	const int textureHeight = (height + factor - 1) / factor;
+
+	texels.resize(static_cast<size_t>(textureWidth) * textureHeight);
+
+	ParallelFor(textureHeight, [&](const size_t begin, const size_t end) {
+		for (size_t outY = begin; outY < end; outY++) {
+			const int startY = static_cast<int>(outY) * factor;
+			const int endY = std::min(startY + factor, height);
+
+			for (int outX = 0; outX < textureWidth; outX++) {
+				const int startX = outX * factor;
+				const int endX = std::min(startX + factor, width);
+
+				float sum = 0.0F;
+
+				for (int y = startY; y < endY; y++) {
+					for (int x = startX; x < endX; x++) {
+						sum -= depthMap[static_cast<size_t>(y) * width + x];
+					}
+				}
+
+				const float depth = std::clamp(sum / static_cast<float>((endY - startY) * (endX - startX)), 0.0F, 1.0F);
+				texels[outY * textureWidth + outX] = static_cast<uint16_t>(depth * 65535.0F + 0.5F);
+			}
+		}
+	});
+}
+
+void HeightField::InitShaders(const std::filesystem::path& cacheDirectory)
+{
+	if (m_shader.program.IsValid()) {
+		return;
+	}
+
+	ShaderSources sources;
+	sources.vertex = b::embed<"res/shaders/heightfield_vertex.glsl">().data();
+	sources.control = b::embed<"res/shaders/heightfield_control.glsl">().data();
+	sources.evaluation = b::embed<"res/shaders/heightfield_evaluation.glsl">().data();
+	sources.fragment = b::embed<"res/shaders/fragment.glsl">().data();
+
+	// The wireframe variant adds barycentric coordinates to the tessellated triangles, as for a compiled mesh.
+	ShaderSources wireframeSources = sources;
+	wireframeSources.geometry = b::embed<"res/shaders/wireframe_geometry.glsl">().data();
+	wireframeSources.fragment = b::embed<"res/shaders/wireframe_fragment.glsl">().data();
+
+	if (!BuildShader(m_shader, sources, cacheDirectory) ||
+	    !BuildShader(m_wireframeShader, wireframeSources, cacheDirectory)) {
+		m_shader.program.Release();
+		std::cout << "Height field preview unavailable!\n";
+	}
+}
+
+bool HeightField::BuildShader(Shader& shader, const ShaderSources& sources,
+                              const std::filesystem::path& cacheDirectory)
+{
+	if (!BuildCachedProgram(shader.program, sources, cacheDirectory)) {
+		return false;
+	}
+
+	shader.mvpLoc = shader.program.GetUniformLocation("mvp");
+	shader.sizeLoc = shader.program.GetUniformLocation("size");
+	shader.thickMinLoc = shader.program.GetUniformLocation("thick_min");
+	shader.depthMaxLoc = shader.program.GetUniformLocation("depth_max");
+	shader.viewportLoc = shader.program.GetUniformLocation("viewport");
+	shader.texelsLoc = shader.program.GetUniformLocation("texels");
+	shader.segmentPixelsLoc = shader.program.GetUniformLocation("segment_pixels");
+
+	// The depth map is always read from the first texture unit.
+	shader.program.Use();
+	glUniform1i(shader.program.GetUniformLocation("depth_map"), 0);
+	glUseProgram(0);
+
+	return true;
+}
+
+void HeightField::Upload(const std::vector<float>& depthMap, const int width, const int height,
+                         const std::string& key)
+{
+	if (!m_shader.program.IsValid() || width <= 0 || height <= 0 ||
+	    depthMap.size() != static_cast<size_t>(width) * static_cast<size_t>(height)) {
+		return;
+	}
+
+	GLint maxTextureSize = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+
+	const int factor = std::max(1, (std::max(width, height) + maxTextureSize - 1) / maxTextureSize);
+	const int textureWidth = (width + factor - 1) / factor;
+	const int textureHeight = (height + factor - 1) / factor;
+
+	std::vector<uint16_t> texels;
+	EncodeDepthTexels(depthMap, width, height, factor, texels);
+
+	m_texture.Create();
+	glActiveTexture(GL_TEXTURE0);
+	m_texture.Bind();
+
+	// Rows of an odd width are not padded to four bytes.
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+
+	// Storage is only reallocated when the size changes, such as for a new crop.
+	if (textureWidth != m_textureWidth || textureHeight != m_textureHeight || m_cornerCount == 0) {
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R16, textureWidth, textureHeight, 0, GL_RED, GL_UNSIGNED_SHORT,
+		             texels.data());
+
+		BuildPatches(textureWidth, textureHeight);
+	} else {
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, textureWidth, textureHeight, GL_RED, GL_UNSIGNED_SHORT,
+		                texels.data());
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	m_key = key;
+	m_width = width;
+	m_height = height;
+	m_textureWidth = textureWidth;
+	m_textureHeight = textureHeight;
+}
+
+void HeightField::BuildPatches(const int textureWidth, const int textureHeight)
+{
+	const int columns = (textureWidth + HEIGHT_FIELD_PATCH_TEXELS - 1) / HEIGHT_FIELD_PATCH_TEXELS;
+	const int rows = (textureHeight + HEIGHT_FIELD_PATCH_TEXELS - 1) / HEIGHT_FIELD_PATCH_TEXELS;
+
+	// Corners are computed from their index alone, so every patch sharing one gets exactly the same coordinate.
+	const auto cornerU = [&](const int column) {
+		return static_cast<float>(std::min(column * HEIGHT_FIELD_PATCH_TEXELS, textureWidth)) / textureWidth;
+	};
+	const auto cornerV = [&](const int row) {
+		return static_cast<float>(std::min(row * HEIGHT_FIELD_PATCH_TEXELS, textureHeight)) / textureHeight;
+	};
+
+	// Each patch is four corners, their texture coordinate and one on the front or zero on the back.
+	std::vector<glm::vec3> corners;
+	corners.reserve((static_cast<size_t>(columns) * rows * 2 + (columns + rows) * 2) * 4);
+
+	const auto addPatch = [&](const glm::vec3& first, const glm::vec3& second, const glm::vec3& third,
+	                          const glm::vec3& fourth) {
+		corners.push_back(first);
+		corners.push_back(second);
+		corners.push_back(third);
+		corners.push_back(fourth);
+	};
+
+	// The front and back are split into the same grid, so the edges of the walls meet theirs.
+	for (const float side : {1.0F, 0.0F}) {
+		for (int row = 0; row < rows; row++) {
+			for (int column = 0; column < columns; column++) {
+				addPatch(glm::vec3(cornerU(column), cornerV(row), side),
+				         glm::vec3(cornerU(column + 1), cornerV(row), side),
+				         glm::vec3(cornerU(column + 1), cornerV(row + 1), side),
+				         glm::vec3(cornerU(column), cornerV(row + 1), side));
+			}
+		}
+	}
+
+	// The walls along the top and bottom, then the left and right, run from the edge of the front to the back.
+	for (int column = 0; column < columns; column++) {
+		for (const float v : {0.0F, 1.0F}) {
+			addPatch(glm::vec3(cornerU(column), v, 1.0F), glm::vec3(cornerU(column + 1), v, 1.0F),
+			         glm::vec3(cornerU(column + 1), v, 0.0F), glm::vec3(cornerU(column), v, 0.0F));
+		}
+	}
+
+	for (int row = 0; row < rows; row++) {
+		for (const float u : {0.0F, 1.0F}) {
+			addPatch(glm::vec3(u, cornerV(row), 1.0F), glm::vec3(u, cornerV(row + 1), 1.0F),
+			         glm::vec3(u, cornerV(row + 1), 0.0F), glm::vec3(u, cornerV(row), 0.0F));
+		}
+	}
+
+	m_vertexArray.Create();
+
+	if (!m_cornerBuffer.BeginWrite(corners.size() * sizeof(glm::vec3))) {
+		std::cout << "Failed to upload the height field patches!\n";
+		m_cornerCount = 0;
+		return;
+	}
+
+	m_cornerBuffer.Write(0, corners.data(), corners.size() * sizeof(glm::vec3));
+
+	m_vertexArray.Bind();
+	m_cornerBuffer.EndWrite();
+
+	// Tell the driver how to read the corners from the buffer.
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), nullptr);
+
+	// Unbind.
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	m_cornerCount = corners.size();
+}
+
+void HeightField::Draw(const glm::mat4& mvp, const Config* config, const int viewportWidth, const int viewportHeight,
+                       const bool wireframe) const
+{
+	if (!IsValid()) {
+		return;
+	}
+
+	// The same dimensions and thickness the compiled mesh would have, centred on the origin.
+	const float width = config->sliderWidth;
+	const float height = config->sliderWidth * static_cast<float>(m_height) / static_cast<float>(m_width);
+
+	const Shader& shader = wireframe ? m_wireframeShader : m_shader;
+
+	shader.program.Use();
+	glUniformMatrix4fv(shader.mvpLoc, 1, GL_FALSE, &mvp[0][0]);
+	glUniform2f(shader.sizeLoc, width, height);
+	glUniform1f(shader.thickMinLoc, config->sliderThickMin);
+	glUniform1f(shader.depthMaxLoc, config->sliderThickMax - config->sliderThickMin);
+	glUniform2f(shader.viewportLoc, static_cast<float>(viewportWidth), static_cast<float>(viewportHeight));
+	glUniform2f(shader.texelsLoc, static_cast<float>(m_textureWidth), static_cast<float>(m_textureHeight));
+	glUniform1f(shader.segmentPixelsLoc, HEIGHT_FIELD_SEGMENT_PIXELS);
+
+	glActiveTexture(GL_TEXTURE0);
+	m_texture.Bind();
+
+	// The winding of the generated triangles differs between the front, back and walls. The surface is closed, so the
+	// depth test alone hides its inside.
+	const GLboolean culling = glIsEnabled(GL_CULL_FACE);
+	glDisable(GL_CULL_FACE);
+
+	m_vertexArray.Bind();
+	glPatchParameteri(GL_PATCH_VERTICES, 4);
+	glDrawArrays(GL_PATCHES, 0, static_cast<GLsizei>(m_cornerCount));
+
+	// Unbind to ensure a clear OpenGL state.
+	glBindVertexArray(0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	if (culling == GL_TRUE) {
+		glEnable(GL_CULL_FACE);
+	}
+}
+
+void HeightField::Release()
+{
+	m_vertexArray.Release();
+	m_cornerBuffer.Release();
+	m_texture.Release();
+
+	m_key.clear();
+	m_width = 0;
+	m_height = 0;
+	m_textureWidth = 0;
+	m_textureHeight = 0;
+	m_cornerCount = 0;
+}
+
+const std::string& HeightField::GetKey() const
+{
+	return m_key;
+}
+
+bool HeightField::IsValid() const
+{
+	return m_shader.program.IsValid() && m_texture.IsValid() && m_cornerCount > 0;
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include <filesystem>
+#include <glm/mat4x4.hpp>
+#include <string>
+#include <vector>
+#include "../declarations/config.h"
+#include "resources.h"
+
+// A preview of the lithophane drawn straight from its depth map, without compiling a mesh. The depth map is held in a
+// 16 bit texture and a coarse grid of patches covering the front, back and walls is displaced by tessellation shaders,
+// each edge split finer the larger it is on screen, down to one texel. GPU memory only depends on the size of the depth
+// map, and the dimensions and thickness are applied while drawing so they update without uploading anything.
+class HeightField {
+public:
+	HeightField() = default;
+
+	// Build the shader programs the height field is drawn with, only the first call does any work. A failure is written
+	// to the console and leaves the preview unavailable.
+	void InitShaders(const std::filesystem::path& cacheDirectory = {});
+
+	// Replace the depth map, which is downsampled if it exceeds the texture size limit. The key identifies where the
+	// depth map came from, to tell when it has to be uploaded again.
+	void Upload(const std::vector<float>& depthMap, int width, int height, const std::string& key);
+	// Draw the height field, with the edges of the tessellated triangles over the surface when wireframe is set.
+	void Draw(const glm::mat4& mvp, const Config* config, int viewportWidth, int viewportHeight, bool wireframe) const;
+	void Release();
+
+	[[nodiscard]] const std::string& GetKey() const;
+	[[nodiscard]] bool IsValid() const;
+private:
+	// A program the height field is drawn with and the locations of its uniforms.
+	struct Shader {
+		ShaderProgram program;
+		int mvpLoc = 0;
+		int sizeLoc = 0;
+		int thickMinLoc = 0;
+		int depthMaxLoc = 0;
+		int viewportLoc = 0;
+		int texelsLoc = 0;
+		int segmentPixelsLoc = 0;
+	};
+
+	static bool BuildShader(Shader& shader, const ShaderSources& sources, const std::filesystem::path& cacheDirectory);
+
+	// Lay out the patches for a depth map texture of the given size.
+	void BuildPatches(int textureWidth, int textureHeight);
+
+	Shader m_shader;
+	Shader m_wireframeShader;
+	VertexArray m_vertexArray;
+	StreamingBuffer m_cornerBuffer = StreamingBuffer(GL_ARRAY_BUFFER);
+	Texture m_texture;
+
+	std::string m_key;
+	int m_width = 0;
+	int m_height = 0;
+	int m_textureWidth = 0;
+	int m_textureHeight = 0;
+	size_t m_cornerCount = 0;
+};
\ No newline at end of file
@@ -0,0 +1,161 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "preview.h"
+#include <algorithm>
+#include <cstdint>
+#include "../declarations/constants.h"
+#include "../parallel.h"
+
+// Box filter the image down by an integer factor, averaging every source pixel under each output pixel. The result is
+// written tightly packed into output.
+void DownsampleImage(const Image& image, const int factor, unsigned char* output)
+{
+	const int width = (image.width + factor - 1) / factor;
+	const int height = (image.height + factor - 1) / factor;
+
+	ParallelFor(height, [&](const size_t begin, const size_t end) {
+		for (size_t outY = begin; outY < end; outY++) {
+			const int startY = static_cast<int>(outY) * factor;
+			const int endY = std::min(startY + factor, image.height);
+
+			for (int outX = 0; outX < width; outX++) {
+				const int startX = outX * factor;
+				const int endX = std::min(startX + factor, image.width);
+
+				uint64_t sum[4] = {0, 0, 0, 0};
+
+				for (int y = startY; y < endY; y++) {
+					const stbi_uc* pixel = image.data + (static_cast<size_t>(y) * image.width + startX) * 4;
+
+					for (int x = startX; x < endX; x++, pixel += 4) {
+						sum[0] += pixel[0];
+						sum[1] += pixel[1];
+						sum[2] += pixel[2];
+						sum[3] += pixel[3];
+					}
+				}
+
+				const uint64_t count = static_cast<uint64_t>(endY - startY) * (endX - startX);
+				unsigned char* target = output + (outY * width + outX) * 4;
+
+				for (int channel = 0; channel < 4; channel++) {
+					target[channel] = static_cast<unsigned char>((sum[channel] + count / 2) / count);
+				}
+			}
+		}
+	});
+}
+
+void PreviewTexture::Upload(const Image& image)
+{
+	// Abandon any upload still in flight, its image has been replaced.
+	if (m_pendingTexture != 0) {
+		glDeleteSync(m_fence);
+		glDeleteBuffers(1, &m_pixelBuffer);
+		glDeleteTextures(1, &m_pendingTexture);
+		m_fence = nullptr;
+		m_pixelBuffer = 0;
+		m_pendingTexture = 0;
+	}
+
+	GLint maxTextureSize = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+
+	// Only a small preview is ever shown, so shrink the image until its larger side fits the preview size.
+	const int maxSize = std::min(PREVIEW_TEXTURE_SIZE, static_cast<int>(maxTextureSize));
+	const int factor = std::max(1, (std::max(image.width, image.height) + maxSize - 1) / maxSize);
+	const int width = (image.width + factor - 1) / factor;
+	const int height = (image.height + factor - 1) / factor;
+	const size_t bufferSize = static_cast<size_t>(width) * height * 4;
+
+	// Write the downsampled pixels straight into driver owned memory, avoiding another copy on upload.
+	glGenBuffers(1, &m_pixelBuffer);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixelBuffer);
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(bufferSize), nullptr, GL_STREAM_DRAW);
+
+	auto* mapped = static_cast<unsigned char*>(glMapBufferRange(
+		GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(bufferSize),
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+
+	if (mapped == nullptr) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		glDeleteBuffers(1, &m_pixelBuffer);
+		m_pixelBuffer = 0;
+		return;
+	}
+
+	DownsampleImage(image, factor, mapped);
+
+	glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+	glGenTextures(1, &m_pendingTexture);
+	glBindTexture(GL_TEXTURE_2D, m_pendingTexture);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	// With a pixel buffer bound the data pointer is an offset into it, so this returns without waiting on the copy.
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glGenerateMipmap(GL_TEXTURE_2D);
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	m_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void PreviewTexture::Poll()
+{
+	if (m_pendingTexture == 0) {
+		return;
+	}
+
+	// Poll without blocking, the texture is swapped in on the first frame the GPU has finished with it.
+	if (const GLenum status = glClientWaitSync(m_fence, 0, 0);
+	    status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+		return;
+	}
+
+	glDeleteSync(m_fence);
+	glDeleteBuffers(1, &m_pixelBuffer);
+
+	if (m_texture != 0) {
+		glDeleteTextures(1, &m_texture);
+	}
+
+	m_texture = m_pendingTexture;
+	m_pendingTexture = 0;
+	m_pixelBuffer = 0;
+	m_fence = nullptr;
+}
+
+void PreviewTexture::Release()
+{
+	if (m_pendingTexture != 0) {
+		glDeleteSync(m_fence);
+		glDeleteBuffers(1, &m_pixelBuffer);
+		glDeleteTextures(1, &m_pendingTexture);
+	}
+
+	if (m_texture != 0) {
+		glDeleteTextures(1, &m_texture);
+	}
+
+	m_texture = 0;
+	m_pendingTexture = 0;
+	m_pixelBuffer = 0;
+	m_fence = nullptr;
+}
+
+GLuint PreviewTexture::GetTexture() const
+{
+	return m_texture;
+}
+
+bool PreviewTexture::IsPending() const
+{
+	return m_pendingTexture != 0;
+}
\ No newline at end of file
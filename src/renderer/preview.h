@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include <glad/gl.h>
+#include "../declarations/structures.h"
+
+// The texture behind the source preview window. It is built from a downsampled copy of the image so it never exceeds
+// the texture size limit, and is uploaded through a pixel buffer object so the transfer happens in the background.
+class PreviewTexture {
+public:
+	PreviewTexture() = default;
+
+	// Start uploading a new image, the previous texture stays available until the new one is ready.
+	void Upload(const Image& image);
+	// Check on an in-flight upload, to be called once per frame.
+	void Poll();
+	void Release();
+
+	[[nodiscard]] GLuint GetTexture() const;
+	[[nodiscard]] bool IsPending() const;
+private:
+	GLuint m_texture = 0;
+
+	// The texture and buffer of an upload that has been issued but not yet completed by the GPU.
+	GLuint m_pendingTexture = 0;
+	GLuint m_pixelBuffer = 0;
+	GLsync m_fence = nullptr;
+};
\ No newline at end of file
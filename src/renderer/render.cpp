@@ -1,14 +1,20 @@
 // SPDX-License-Identifier: GPL-3.0
 #include "render.h"
+#include <algorithm>
 #include <glad/gl.h>
 #include <glm/mat4x4.hpp>
 #include "../declarations/constants.h"
+#include "../storage.h"
 
 Render::Render(GLFWwindow* window, Config* config) : m_window(window), m_config(config)
 {
 	// Ensure our OpenGL configurations will affect the correct context.
 	glfwMakeContextCurrent(window);
 
+	// Build the shader programs upfront, they are shared by every model loaded later.
+	entity.InitShaders(GetCacheDirectory());
+	heightField.InitShaders(GetCacheDirectory());
+
 	// Move the starting position of the entity.
 	entity.SetPosition(glm::vec3(0.0F, 0.0F, 2.0F));
 
@@ -16,27 +22,87 @@ Render::Render(GLFWwindow* window, Config* config) : m_window(window), m_config(
 	CalcViewport(DEFAULT_WINDOW_WIDTH, DEFAULT_WINDOW_HEIGHT);
 }
 
-void Render::Draw() const
+void Render::Draw()
 {
-	// Only draw if desired and if a model has been compiled.
-	if (m_config->drawPreview && entity.HasModel()) {
-		glm::mat4 mvp(1.0F);
-		camera.ApplyMatrix(mvp, GetAspectRatio());
-		entity.Draw(mvp);
+	// Large meshes are uploaded a piece per frame, the previous mesh is drawn until they are complete.
+	entity.ContinueUpload();
+
+	if (!m_config->drawPreview) {
+		return;
+	}
+
+	// The live height field replaces the compiled model while it is enabled, which is only drawn once compiled.
+	const bool drawHeightField = m_config->drawHeightField && heightField.IsValid();
+
+	if (!drawHeightField && !entity.HasModel()) {
+		return;
+	}
+
+	glm::mat4 mvp(1.0F);
+	camera.ApplyMatrix(mvp, GetAspectRatio());
+
+	// While the camera moves, fewer pixels are shaded by drawing into a smaller framebuffer that is then scaled up to
+	// the viewport. The height field is tessellated for the smaller size too.
+	const bool moving = IsCameraMoving();
+	const int reducedWidth = std::max(1, static_cast<int>(m_viewportWidth * INTERACTION_RESOLUTION_SCALE));
+	const int reducedHeight = std::max(1, static_cast<int>(m_viewportHeight * INTERACTION_RESOLUTION_SCALE));
+	const bool reduced = moving && m_reducedFramebuffer.Create(reducedWidth, reducedHeight);
+	const int width = reduced ? m_reducedFramebuffer.GetWidth() : m_viewportWidth;
+	const int height = reduced ? m_reducedFramebuffer.GetHeight() : m_viewportHeight;
+
+	if (reduced) {
+		m_reducedFramebuffer.Bind();
+		glViewport(0, 0, width, height);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	}
+
+	if (drawHeightField) {
+		heightField.Draw(mvp, m_config, width, height, m_config->drawWireframe);
+	} else {
+		entity.Draw(mvp, m_config->drawWireframe, moving);
+	}
+
+	if (reduced) {
+		m_reducedFramebuffer.BlitToScreen(GUI_SIDEPANEL_WIDTH, 0, m_viewportWidth, m_viewportHeight);
+		glViewport(GUI_SIDEPANEL_WIDTH, 0, m_viewportWidth, m_viewportHeight);
 	}
 }
 
-void Render::UpdateWireframe() const
+bool Render::HasModel() const
 {
-	// Render back side of wireframe faces.
-	if (m_config->drawWireframe) {
-		glDisable(GL_CULL_FACE);
-	} else {
-		glEnable(GL_CULL_FACE);
+	return entity.HasModel() || (m_config->drawHeightField && heightField.IsValid());
+}
+
+void Render::RequestRedraw()
+{
+	m_redrawFrames = REDRAW_FRAMES;
+}
+
+bool Render::ConsumeRedraw()
+{
+	if (m_redrawFrames == 0) {
+		return false;
 	}
 
-	// Toggle line rendering.
-	glPolygonMode(GL_FRONT_AND_BACK, m_config->drawWireframe ? GL_LINE : GL_FILL);
+	m_redrawFrames--;
+
+	return true;
+}
+
+bool Render::IsBusy() const
+{
+	// Frames keep being drawn until the camera settles, so the last one is at full quality.
+	return entity.IsUploading() || preview.IsPending() || IsCameraMoving();
+}
+
+void Render::NotifyCameraMoved()
+{
+	m_cameraMovedTime = glfwGetTime();
+}
+
+bool Render::IsCameraMoving() const
+{
+	return m_config->drawReducedWhileMoving && glfwGetTime() - m_cameraMovedTime < INTERACTION_SETTLE_TIME;
 }
 
 void Render::CalcViewport(int width, int height)
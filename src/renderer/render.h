@@ -3,15 +3,31 @@
 
 #include <GLFW/glfw3.h>
 #include "../declarations/config.h"
+#include "../declarations/constants.h"
 #include "camera.h"
 #include "entity.h"
+#include "heightfield.h"
+#include "preview.h"
 
 class Render {
 public:
 	explicit Render(GLFWwindow* window, Config* config);
-	void Draw() const;
+	void Draw();
+
+	// Frames are only drawn while something on screen may change. Ask for the next few to be drawn after any change.
+	void RequestRedraw();
+	// Whether the next frame should be drawn, counting down the frames requested.
+	bool ConsumeRedraw();
+	// Whether the 3D preview has anything to show, either a mesh or the height field.
+	[[nodiscard]] bool HasModel() const;
+	// Whether work in progress needs frames drawn to advance, such as a mesh being uploaded.
+	[[nodiscard]] bool IsBusy() const;
+
+	// Record that the camera was rotated or zoomed. Until it settles the preview is drawn at a lower resolution and
+	// large meshes are replaced by their proxy, if enabled in the config.
+	void NotifyCameraMoved();
+	[[nodiscard]] bool IsCameraMoving() const;
 
-	void UpdateWireframe() const;
 	void CalcViewport(int width, int height);
 
 	[[nodiscard]] int GetViewportWidth() const;
@@ -20,10 +36,18 @@ class Render {
 
 	Camera camera;
 	Entity entity;
+	HeightField heightField;
+	PreviewTexture preview;
 private:
 	GLFWwindow* m_window = nullptr;
 	Config* m_config = nullptr;
 
+	int m_redrawFrames = REDRAW_FRAMES;
+
+	// When the camera last moved, from glfwGetTime, and the framebuffer the preview is drawn into meanwhile.
+	double m_cameraMovedTime = -INTERACTION_SETTLE_TIME;
+	Framebuffer m_reducedFramebuffer;
+
 	int m_viewportWidth = 0;
 	int m_viewportHeight = 0;
 	float m_aspectRatio = 0.0F;
@@ -0,0 +1,581 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "resources.h"
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <utility>
+#include "../parallel.h"
+
+// Storage is given back once the data uploaded is smaller than this fraction of it, so one huge mesh does not hold on
+// to its memory for the rest of the session.
+constexpr size_t GPU_BUFFER_SHRINK_FACTOR = 4;
+
+// The size of the pieces a write to a mapped streaming buffer is split into across threads.
+constexpr size_t STREAMING_COPY_BLOCK_SIZE = 1 << 20;
+
+// How long to wait on a fence at a time before waiting again, in nanoseconds.
+constexpr GLuint64 STREAMING_BUFFER_WAIT_NS = 1000000;
+
+// Copy a block of memory using every hardware thread, for filling mapped buffers with large meshes.
+void CopyParallel(void* target, const void* source, const size_t size)
+{
+	ParallelFor(
+		(size + STREAMING_COPY_BLOCK_SIZE - 1) / STREAMING_COPY_BLOCK_SIZE,
+		[&](const size_t begin, const size_t end) {
+			const size_t first = begin * STREAMING_COPY_BLOCK_SIZE;
+			const size_t last = std::min(end * STREAMING_COPY_BLOCK_SIZE, size);
+
+			memcpy(static_cast<unsigned char*>(target) + first, static_cast<const unsigned char*>(source) + first,
+			       last - first);
+		},
+		4);
+}
+
+StreamingBuffer::StreamingBuffer(const GLenum target) : m_target(target) {}
+
+StreamingBuffer::~StreamingBuffer()
+{
+	Release();
+}
+
+StreamingBuffer::StreamingBuffer(StreamingBuffer&& other) noexcept
+	: m_target(other.m_target), m_current(std::exchange(other.m_current, {})),
+	  m_spare(std::exchange(other.m_spare, {}))
+{
+}
+
+StreamingBuffer& StreamingBuffer::operator=(StreamingBuffer&& other) noexcept
+{
+	if (this != &other) {
+		Release();
+
+		m_target = other.m_target;
+		m_current = std::exchange(other.m_current, {});
+		m_spare = std::exchange(other.m_spare, {});
+	}
+
+	return *this;
+}
+
+bool StreamingBuffer::BeginWrite(const size_t size)
+{
+	// Only the spare is ever reallocated, so the current contents stay on screen whatever the new size.
+	if (size > m_spare.capacity || size < m_spare.capacity / GPU_BUFFER_SHRINK_FACTOR) {
+		return Allocate(m_spare, std::max<size_t>(1, size));
+	}
+
+	// Wait for draws issued before the spare was swapped out, they are long finished in all but the first frames.
+	if (m_spare.fence != nullptr) {
+		while (glClientWaitSync(m_spare.fence, GL_SYNC_FLUSH_COMMANDS_BIT, STREAMING_BUFFER_WAIT_NS) ==
+		       GL_TIMEOUT_EXPIRED) {
+		}
+
+		glDeleteSync(m_spare.fence);
+		m_spare.fence = nullptr;
+	}
+
+	return true;
+}
+
+void StreamingBuffer::Write(const size_t offset, const void* data, const size_t size)
+{
+	if (m_spare.mapped != nullptr) {
+		CopyParallel(m_spare.mapped + offset, data, size);
+		return;
+	}
+
+	// The copy target leaves the bindings used for drawing, including those of any bound vertex array, untouched.
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_spare.buffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void StreamingBuffer::EndWrite()
+{
+	// Coherent mappings need no flush, writes that happened before this call, on whichever thread, are visible to
+	// every command issued after it. Every draw from the current buffer has been issued by now, so a fence placed here
+	// guards all of them.
+	std::swap(m_current, m_spare);
+
+	if (m_spare.buffer != 0) {
+		m_spare.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	Bind();
+}
+
+bool StreamingBuffer::IsSpareMapped() const
+{
+	return m_spare.mapped != nullptr;
+}
+
+void StreamingBuffer::Bind() const
+{
+	glBindBuffer(m_target, m_current.buffer);
+}
+
+void StreamingBuffer::Release()
+{
+	Release(m_current);
+	Release(m_spare);
+}
+
+bool StreamingBuffer::Allocate(Storage& storage, const size_t capacity)
+{
+	// The driver keeps the old storage alive until draws reading it have finished.
+	Release(storage);
+
+	glGenBuffers(1, &storage.buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, storage.buffer);
+
+	// Immutable storage, and with it persistent mapping, is core from OpenGL 4.4.
+	if (GLAD_GL_VERSION_4_4 != 0) {
+		constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+		glBufferStorage(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(capacity), nullptr, flags);
+		storage.mapped = static_cast<unsigned char*>(
+			glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, static_cast<GLsizeiptr>(capacity), flags));
+	} else {
+		glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(capacity), nullptr, GL_STATIC_DRAW);
+	}
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	if (GLAD_GL_VERSION_4_4 != 0 && storage.mapped == nullptr) {
+		std::cout << "Failed to map streaming buffer!\n";
+		Release(storage);
+		return false;
+	}
+
+	storage.capacity = capacity;
+
+	return true;
+}
+
+void StreamingBuffer::Release(Storage& storage)
+{
+	if (storage.fence != nullptr) {
+		glDeleteSync(storage.fence);
+	}
+
+	// Deleting a buffer unmaps it.
+	if (storage.buffer != 0) {
+		glDeleteBuffers(1, &storage.buffer);
+	}
+
+	storage = Storage();
+}
+
+VertexArray::~VertexArray()
+{
+	Release();
+}
+
+VertexArray::VertexArray(VertexArray&& other) noexcept : m_vertexArray(std::exchange(other.m_vertexArray, 0)) {}
+
+VertexArray& VertexArray::operator=(VertexArray&& other) noexcept
+{
+	if (this != &other) {
+		Release();
+		m_vertexArray = std::exchange(other.m_vertexArray, 0);
+	}
+
+	return *this;
+}
+
+void VertexArray::Create()
+{
+	if (m_vertexArray == 0) {
+		glGenVertexArrays(1, &m_vertexArray);
+	}
+}
+
+void VertexArray::Bind() const
+{
+	glBindVertexArray(m_vertexArray);
+}
+
+void VertexArray::Release()
+{
+	if (m_vertexArray != 0) {
+		glDeleteVertexArrays(1, &m_vertexArray);
+	}
+
+	m_vertexArray = 0;
+}
+
+bool VertexArray::IsValid() const
+{
+	return m_vertexArray != 0;
+}
+
+Texture::~Texture()
+{
+	Release();
+}
+
+Texture::Texture(Texture&& other) noexcept : m_texture(std::exchange(other.m_texture, 0)) {}
+
+Texture& Texture::operator=(Texture&& other) noexcept
+{
+	if (this != &other) {
+		Release();
+		m_texture = std::exchange(other.m_texture, 0);
+	}
+
+	return *this;
+}
+
+void Texture::Create()
+{
+	if (m_texture == 0) {
+		glGenTextures(1, &m_texture);
+	}
+}
+
+void Texture::Bind() const
+{
+	glBindTexture(GL_TEXTURE_2D, m_texture);
+}
+
+void Texture::Release()
+{
+	if (m_texture != 0) {
+		glDeleteTextures(1, &m_texture);
+	}
+
+	m_texture = 0;
+}
+
+bool Texture::IsValid() const
+{
+	return m_texture != 0;
+}
+
+Framebuffer::~Framebuffer()
+{
+	Release();
+}
+
+Framebuffer::Framebuffer(Framebuffer&& other) noexcept
+	: m_framebuffer(std::exchange(other.m_framebuffer, 0)), m_colorBuffer(std::exchange(other.m_colorBuffer, 0)),
+	  m_depthBuffer(std::exchange(other.m_depthBuffer, 0)), m_width(std::exchange(other.m_width, 0)),
+	  m_height(std::exchange(other.m_height, 0))
+{
+}
+
+Framebuffer& Framebuffer::operator=(Framebuffer&& other) noexcept
+{
+	if (this != &other) {
+		Release();
+		m_framebuffer = std::exchange(other.m_framebuffer, 0);
+		m_colorBuffer = std::exchange(other.m_colorBuffer, 0);
+		m_depthBuffer = std::exchange(other.m_depthBuffer, 0);
+		m_width = std::exchange(other.m_width, 0);
+		m_height = std::exchange(other.m_height, 0);
+	}
+
+	return *this;
+}
+
+bool Framebuffer::Create(const int width, const int height)
+{
+	if (m_framebuffer != 0 && width == m_width && height == m_height) {
+		return true;
+	}
+
+	Release();
+
+	if (width <= 0 || height <= 0) {
+		return false;
+	}
+
+	glGenRenderbuffers(1, &m_colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+	glGenRenderbuffers(1, &m_depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer);
+
+	const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (status != GL_FRAMEBUFFER_COMPLETE) {
+		std::cout << "Framebuffer incomplete with status \"" << status << "\"!\n";
+		Release();
+		return false;
+	}
+
+	m_width = width;
+	m_height = height;
+
+	return true;
+}
+
+void Framebuffer::Bind() const
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+}
+
+void Framebuffer::BlitToScreen(const int x, const int y, const int width, const int height) const
+{
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	glBlitFramebuffer(0, 0, m_width, m_height, x, y, x + width, y + height, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void Framebuffer::Release()
+{
+	if (m_framebuffer != 0) {
+		glDeleteFramebuffers(1, &m_framebuffer);
+	}
+
+	if (m_colorBuffer != 0) {
+		glDeleteRenderbuffers(1, &m_colorBuffer);
+	}
+
+	if (m_depthBuffer != 0) {
+		glDeleteRenderbuffers(1, &m_depthBuffer);
+	}
+
+	m_framebuffer = 0;
+	m_colorBuffer = 0;
+	m_depthBuffer = 0;
+	m_width = 0;
+	m_height = 0;
+}
+
+int Framebuffer::GetWidth() const
+{
+	return m_width;
+}
+
+int Framebuffer::GetHeight() const
+{
+	return m_height;
+}
+
+bool Framebuffer::IsValid() const
+{
+	return m_framebuffer != 0;
+}
+
+// Compile a single shader stage, zero if it failed.
+GLuint CompileShader(const char* source, const GLenum shaderType)
+{
+	const size_t length = strlen(source);
+
+	if (length > INT_MAX) {
+		std::cout << "Shader source of type \"" << shaderType << "\" too large!\n";
+		return 0;
+	}
+
+	const GLuint shader = glCreateShader(shaderType);
+
+	if (shader == 0) {
+		std::cout << "Error creating shader type!\n";
+		return 0;
+	}
+
+	const GLint sourceLength = static_cast<GLint>(length);
+	GLint success = 0;
+
+	glShaderSource(shader, 1, &source, &sourceLength);
+	glCompileShader(shader);
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+
+	if (success == 0) {
+		char infoLog[512];
+		glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+		std::cout << "Failed to compile shader type \"" << shaderType << "\":\n" << infoLog << '\n';
+		glDeleteShader(shader);
+		return 0;
+	}
+
+	return shader;
+}
+
+// Whether the program linked, writing the log of the driver to the console if it did not and report is set.
+bool IsLinked(const GLuint program, const bool report)
+{
+	GLint success = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+
+	if (success == 0 && report) {
+		char infoLog[512];
+		glGetProgramInfoLog(program, 512, nullptr, infoLog);
+		std::cout << "Failed to link shader program:\n" << infoLog << '\n';
+	}
+
+	return success != 0;
+}
+
+bool HasProgramBinarySupport()
+{
+	if (GLAD_GL_VERSION_4_1 == 0) {
+		return false;
+	}
+
+	GLint formatCount = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+
+	return formatCount > 0;
+}
+
+ShaderProgram::~ShaderProgram()
+{
+	Release();
+}
+
+ShaderProgram::ShaderProgram(ShaderProgram&& other) noexcept : m_program(std::exchange(other.m_program, 0)) {}
+
+ShaderProgram& ShaderProgram::operator=(ShaderProgram&& other) noexcept
+{
+	if (this != &other) {
+		Release();
+		m_program = std::exchange(other.m_program, 0);
+	}
+
+	return *this;
+}
+
+bool ShaderProgram::Build(const ShaderSources& sources)
+{
+	Release();
+
+	const std::array<std::pair<const char*, GLenum>, 5> stages = {{
+		{sources.vertex, GL_VERTEX_SHADER},
+		{sources.control, GL_TESS_CONTROL_SHADER},
+		{sources.evaluation, GL_TESS_EVALUATION_SHADER},
+		{sources.geometry, GL_GEOMETRY_SHADER},
+		{sources.fragment, GL_FRAGMENT_SHADER},
+	}};
+
+	std::array<GLuint, 5> shaders = {0, 0, 0, 0, 0};
+	bool compiled = true;
+
+	for (size_t stage = 0; stage < stages.size(); stage++) {
+		if (stages[stage].first != nullptr) {
+			shaders[stage] = CompileShader(stages[stage].first, stages[stage].second);
+			compiled = compiled && shaders[stage] != 0;
+		}
+	}
+
+	const GLuint program = compiled ? glCreateProgram() : 0;
+
+	if (program != 0) {
+		// Without the hint the driver may discard what it needs to hand the binary back later.
+		if (HasProgramBinarySupport()) {
+			glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+
+		for (const GLuint shader : shaders) {
+			if (shader != 0) {
+				glAttachShader(program, shader);
+			}
+		}
+
+		glLinkProgram(program);
+	}
+
+	// The shaders are only needed until the program is linked, deleting zero is ignored.
+	for (const GLuint shader : shaders) {
+		glDeleteShader(shader);
+	}
+
+	if (program == 0) {
+		std::cout << "Error creating shader program!\n";
+		return false;
+	}
+
+	if (!IsLinked(program, true)) {
+		glDeleteProgram(program);
+		return false;
+	}
+
+	m_program = program;
+
+	return true;
+}
+
+bool ShaderProgram::LoadBinary(const GLenum format, const void* data, const size_t size)
+{
+	Release();
+
+	if (!HasProgramBinarySupport() || size > INT_MAX) {
+		return false;
+	}
+
+	const GLuint program = glCreateProgram();
+
+	if (program == 0) {
+		return false;
+	}
+
+	glProgramBinary(program, format, data, static_cast<GLsizei>(size));
+
+	if (!IsLinked(program, false)) {
+		glDeleteProgram(program);
+		return false;
+	}
+
+	m_program = program;
+
+	return true;
+}
+
+bool ShaderProgram::GetBinary(GLenum& format, std::vector<unsigned char>& binary) const
+{
+	if (m_program == 0 || !HasProgramBinarySupport()) {
+		return false;
+	}
+
+	GLint length = 0;
+	glGetProgramiv(m_program, GL_PROGRAM_BINARY_LENGTH, &length);
+
+	if (length <= 0) {
+		return false;
+	}
+
+	binary.resize(static_cast<size_t>(length));
+
+	GLsizei written = 0;
+	glGetProgramBinary(m_program, length, &written, &format, binary.data());
+	binary.resize(static_cast<size_t>(written));
+
+	return written > 0;
+}
+
+void ShaderProgram::Use() const
+{
+	glUseProgram(m_program);
+}
+
+void ShaderProgram::Release()
+{
+	if (m_program != 0) {
+		glDeleteProgram(m_program);
+	}
+
+	m_program = 0;
+}
+
+GLint ShaderProgram::GetUniformLocation(const char* name) const
+{
+	return glGetUniformLocation(m_program, name);
+}
+
+bool ShaderProgram::IsValid() const
+{
+	return m_program != 0;
+}
\ No newline at end of file
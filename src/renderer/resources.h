@@ -0,0 +1,168 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include <cstddef>
+#include <glad/gl.h>
+#include <vector>
+
+// The GPU resources below own their OpenGL object and delete it when destroyed, so replacing one never leaks the old.
+// They can be moved but not copied, and must only be used on the thread holding the OpenGL context.
+
+// A buffer object bound to one target, for data replaced often such as the mesh of a live preview. It holds the
+// current contents that draws read from and a spare buffer the next contents are written into, possibly over many
+// frames, before the two are swapped at once. A fence placed when a buffer is swapped out guards it until the GPU has
+// finished with it, so the spare is only ever written once nothing reads it. On OpenGL 4.4 the spare stays
+// persistently mapped, older contexts fall back to copying into it through the driver. Storage grows to fit the data
+// and is given back once the data is far smaller than what is held.
+class StreamingBuffer {
+public:
+	explicit StreamingBuffer(GLenum target);
+	~StreamingBuffer();
+
+	StreamingBuffer(StreamingBuffer&& other) noexcept;
+	StreamingBuffer& operator=(StreamingBuffer&& other) noexcept;
+	StreamingBuffer(const StreamingBuffer&) = delete;
+	StreamingBuffer& operator=(const StreamingBuffer&) = delete;
+
+	// Start replacing the contents with size bytes, abandoning any write in progress. Draws keep reading the current
+	// contents until EndWrite.
+	bool BeginWrite(size_t size);
+	// Write part of the new contents.
+	void Write(size_t offset, const void* data, size_t size);
+	// Finish writing, draws read the new contents from now on. The buffer is left bound to its target.
+	void EndWrite();
+	// Whether the spare is persistently mapped after BeginWrite. Writes to it then make no OpenGL calls, so any thread
+	// may make them as long as EndWrite waits until they have finished.
+	[[nodiscard]] bool IsSpareMapped() const;
+	void Bind() const;
+	void Release();
+private:
+	// One buffer object and what is known about it.
+	struct Storage {
+		GLuint buffer = 0;
+		unsigned char* mapped = nullptr;
+		size_t capacity = 0;
+		GLsync fence = nullptr;
+	};
+
+	static bool Allocate(Storage& storage, size_t capacity);
+	static void Release(Storage& storage);
+
+	GLenum m_target = 0;
+	Storage m_current;
+	Storage m_spare;
+};
+
+// A vertex array object, recording the vertex layout and buffers a mesh is drawn from.
+class VertexArray {
+public:
+	VertexArray() = default;
+	~VertexArray();
+
+	VertexArray(VertexArray&& other) noexcept;
+	VertexArray& operator=(VertexArray&& other) noexcept;
+	VertexArray(const VertexArray&) = delete;
+	VertexArray& operator=(const VertexArray&) = delete;
+
+	// Create the vertex array unless it already exists.
+	void Create();
+	void Bind() const;
+	void Release();
+
+	[[nodiscard]] bool IsValid() const;
+private:
+	GLuint m_vertexArray = 0;
+};
+
+// A two dimensional texture, such as one a shader samples data from.
+class Texture {
+public:
+	Texture() = default;
+	~Texture();
+
+	Texture(Texture&& other) noexcept;
+	Texture& operator=(Texture&& other) noexcept;
+	Texture(const Texture&) = delete;
+	Texture& operator=(const Texture&) = delete;
+
+	// Create the texture unless it already exists.
+	void Create();
+	// Bind the texture to the active texture unit.
+	void Bind() const;
+	void Release();
+
+	[[nodiscard]] bool IsValid() const;
+private:
+	GLuint m_texture = 0;
+};
+
+// An offscreen framebuffer with a colour and a depth buffer, for drawing at a different resolution than the window.
+class Framebuffer {
+public:
+	Framebuffer() = default;
+	~Framebuffer();
+
+	Framebuffer(Framebuffer&& other) noexcept;
+	Framebuffer& operator=(Framebuffer&& other) noexcept;
+	Framebuffer(const Framebuffer&) = delete;
+	Framebuffer& operator=(const Framebuffer&) = delete;
+
+	// Create the framebuffer at the given size, only reallocating when the size changes. Returns false if the driver
+	// can not draw to it, leaving it released.
+	bool Create(int width, int height);
+	// Bind the framebuffer for drawing, the default framebuffer is bound again with glBindFramebuffer.
+	void Bind() const;
+	// Copy the colour buffer into a region of the default framebuffer, filtered linearly when scaled.
+	void BlitToScreen(int x, int y, int width, int height) const;
+	void Release();
+
+	[[nodiscard]] int GetWidth() const;
+	[[nodiscard]] int GetHeight() const;
+	[[nodiscard]] bool IsValid() const;
+private:
+	GLuint m_framebuffer = 0;
+	GLuint m_colorBuffer = 0;
+	GLuint m_depthBuffer = 0;
+	int m_width = 0;
+	int m_height = 0;
+};
+
+// Whether the driver can save and restore linked programs, which needs OpenGL 4.1 and at least one binary format.
+bool HasProgramBinarySupport();
+
+// The GLSL source of each stage of a shader program, stages left null are skipped. Tessellation needs OpenGL 4.0.
+struct ShaderSources {
+	const char* vertex = nullptr;
+	const char* control = nullptr;
+	const char* evaluation = nullptr;
+	const char* geometry = nullptr;
+	const char* fragment = nullptr;
+};
+
+// A linked shader program, from a vertex and a fragment shader and any stages between them.
+class ShaderProgram {
+public:
+	ShaderProgram() = default;
+	~ShaderProgram();
+
+	ShaderProgram(ShaderProgram&& other) noexcept;
+	ShaderProgram& operator=(ShaderProgram&& other) noexcept;
+	ShaderProgram(const ShaderProgram&) = delete;
+	ShaderProgram& operator=(const ShaderProgram&) = delete;
+
+	// Compile and link the program from GLSL source, replacing any previous program. Failures are written to the
+	// console with the log of the driver.
+	bool Build(const ShaderSources& sources);
+	// Link the program from a binary given by GetBinary, which the driver may reject after it has been updated. Unlike
+	// Build, a rejected binary is not reported.
+	bool LoadBinary(GLenum format, const void* data, size_t size);
+	// The linked program in the format of the driver, false if the driver can not provide it.
+	bool GetBinary(GLenum& format, std::vector<unsigned char>& binary) const;
+	void Use() const;
+	void Release();
+
+	[[nodiscard]] GLint GetUniformLocation(const char* name) const;
+	[[nodiscard]] bool IsValid() const;
+private:
+	GLuint m_program = 0;
+};
\ No newline at end of file
@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "shadercache.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../exporter/file.h"
+#include "../exporting.h"
+#include "../hashing.h"
+#include "../mapping.h"
+
+// Precedes the binary, followed by the identity it was linked under to resolve hash collisions.
+struct ProgramBinaryHeader {
+	char magic[4] = {'L', 'G', 'P', 'B'};
+	uint32_t format = 0;
+	uint32_t identityLength = 0;
+	uint32_t binarySize = 0;
+};
+
+// Everything a program binary depends on. Drivers only promise to accept binaries from the same driver and hardware.
+std::string GetProgramIdentity(const ShaderSources& sources)
+{
+	std::string identity;
+
+	for (const GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+		if (const auto* value = reinterpret_cast<const char*>(glGetString(name)); value != nullptr) {
+			identity += value;
+		}
+
+		identity += '\n';
+	}
+
+	// Absent stages still take part, so moving a source between stages changes the hash.
+	uint64_t sourceHash = 0;
+
+	const char* stages[] = {sources.vertex, sources.control, sources.evaluation, sources.geometry, sources.fragment};
+
+	for (const char* source : stages) {
+		sourceHash = CombineHash(sourceHash, source != nullptr ? HashBytes(source, strlen(source)) : 0);
+	}
+
+	char hash[24];
+	snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(sourceHash));
+
+	return identity + hash;
+}
+
+bool LoadProgramBinary(ShaderProgram& program, const std::filesystem::path& path, const std::string& identity)
+{
+	MappedFile file;
+	std::error_code error;
+
+	if (!std::filesystem::is_regular_file(path, error) || !file.Open(path.string().c_str()) ||
+	    file.GetSize() < sizeof(ProgramBinaryHeader)) {
+		return false;
+	}
+
+	ProgramBinaryHeader header;
+	memcpy(&header, file.GetData(), sizeof(ProgramBinaryHeader));
+
+	// Reject foreign files, truncated files and hash collisions.
+	if (memcmp(header.magic, ProgramBinaryHeader().magic, 4) != 0 || header.identityLength != identity.size() ||
+	    file.GetSize() != sizeof(ProgramBinaryHeader) + header.identityLength + header.binarySize ||
+	    memcmp(file.GetData() + sizeof(ProgramBinaryHeader), identity.data(), identity.size()) != 0) {
+		return false;
+	}
+
+	return program.LoadBinary(header.format, file.GetData() + sizeof(ProgramBinaryHeader) + identity.size(),
+	                          header.binarySize);
+}
+
+void StoreProgramBinary(const ShaderProgram& program, const std::filesystem::path& path, const std::string& identity)
+{
+	ProgramBinaryHeader header;
+	std::vector<unsigned char> binary;
+
+	if (!program.GetBinary(header.format, binary)) {
+		return;
+	}
+
+	header.identityLength = static_cast<uint32_t>(identity.size());
+	header.binarySize = static_cast<uint32_t>(binary.size());
+
+	const std::string temporaryPath = GetTemporaryPath(path.string());
+	OutputFile file;
+
+	bool success = file.Open(temporaryPath.c_str()) && file.WriteAt(&header, sizeof(ProgramBinaryHeader), 0) &&
+	               file.WriteAt(identity.data(), identity.size(), sizeof(ProgramBinaryHeader)) &&
+	               file.WriteAt(binary.data(), binary.size(), sizeof(ProgramBinaryHeader) + identity.size());
+	success = file.Close() && success && RenameFile(temporaryPath.c_str(), path.string().c_str());
+
+	if (!success) {
+		RemoveFile(temporaryPath.c_str());
+	}
+}
+
+bool BuildCachedProgram(ShaderProgram& program, const ShaderSources& sources,
+                        const std::filesystem::path& cacheDirectory)
+{
+	const auto startTime = std::chrono::high_resolution_clock::now();
+
+	std::filesystem::path path;
+	std::string identity;
+
+	if (!cacheDirectory.empty() && HasProgramBinarySupport()) {
+		const std::filesystem::path directory = cacheDirectory / "shaders";
+		std::error_code error;
+		std::filesystem::create_directories(directory, error);
+
+		if (!error) {
+			identity = GetProgramIdentity(sources);
+
+			char name[32];
+			snprintf(name, sizeof(name), "%016llx.bin",
+			         static_cast<unsigned long long>(HashBytes(identity.data(), identity.size())));
+			path = directory / name;
+
+			if (LoadProgramBinary(program, path, identity)) {
+				const std::chrono::duration<double, std::milli> elapsedTime =
+					std::chrono::high_resolution_clock::now() - startTime;
+
+				std::cout << "Shader program loaded from cache in " << elapsedTime.count() << "ms\n";
+				return true;
+			}
+		}
+	}
+
+	if (!program.Build(sources)) {
+		return false;
+	}
+
+	const std::chrono::duration<double, std::milli> elapsedTime =
+		std::chrono::high_resolution_clock::now() - startTime;
+
+	std::cout << "Shader program compiled in " << elapsedTime.count() << "ms\n";
+
+	if (!path.empty()) {
+		StoreProgramBinary(program, path, identity);
+	}
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include <filesystem>
+#include "resources.h"
+
+// Build a shader program from GLSL source, reusing the binary the driver linked on a previous run when it still accepts
+// it. Binaries are kept in a subdirectory of the cache directory, keyed by the vendor, renderer and version of the
+// driver and by the source, so an updated driver or shader never loads a stale binary. The program is compiled from
+// source whenever there is no usable binary, and an empty directory disables the cache.
+bool BuildCachedProgram(ShaderProgram& program, const ShaderSources& sources,
+                        const std::filesystem::path& cacheDirectory);
\ No newline at end of file
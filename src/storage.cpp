@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "storage.h"
+#include <cstdlib>
+#include <iostream>
+
+// Create the directory if it does not exist yet, the kind names it in the message on failure.
+std::filesystem::path EnsureDirectory(const std::filesystem::path& directory, const char* kind)
+{
+	if (directory.empty()) {
+		return directory;
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+
+	if (error) {
+		std::cout << "Failed to create " << kind << " directory \"" << directory.string() << "\": " << error.message()
+		          << '\n';
+		return {};
+	}
+
+	return directory;
+}
+
+std::filesystem::path GetCacheDirectory()
+{
+	std::filesystem::path directory;
+
+#ifdef OS_WINDOWS
+	if (const char* localAppData = std::getenv("LOCALAPPDATA"); localAppData != nullptr) {
+		directory = std::filesystem::path(localAppData) / "LithoGen" / "Cache";
+	}
+#elif defined(__APPLE__)
+	if (const char* home = std::getenv("HOME"); home != nullptr) {
+		directory = std::filesystem::path(home) / "Library" / "Caches" / "LithoGen";
+	}
+#else
+	// Follow the XDG base directory specification.
+	if (const char* cacheHome = std::getenv("XDG_CACHE_HOME"); cacheHome != nullptr && *cacheHome != '\0') {
+		directory = std::filesystem::path(cacheHome) / "lithogen";
+	} else if (const char* home = std::getenv("HOME"); home != nullptr) {
+		directory = std::filesystem::path(home) / ".cache" / "lithogen";
+	}
+#endif
+
+	return EnsureDirectory(directory, "cache");
+}
+
+std::filesystem::path GetConfigDirectory()
+{
+	std::filesystem::path directory;
+
+#ifdef OS_WINDOWS
+	if (const char* appData = std::getenv("APPDATA"); appData != nullptr) {
+		directory = std::filesystem::path(appData) / "LithoGen";
+	}
+#elif defined(__APPLE__)
+	if (const char* home = std::getenv("HOME"); home != nullptr) {
+		directory = std::filesystem::path(home) / "Library" / "Application Support" / "LithoGen";
+	}
+#else
+	if (const char* configHome = std::getenv("XDG_CONFIG_HOME"); configHome != nullptr && *configHome != '\0') {
+		directory = std::filesystem::path(configHome) / "lithogen";
+	} else if (const char* home = std::getenv("HOME"); home != nullptr) {
+		directory = std::filesystem::path(home) / ".config" / "lithogen";
+	}
+#endif
+
+	return EnsureDirectory(directory, "configuration");
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include <filesystem>
+
+// The per-user directory for caches that can be safely deleted at any time, created on first use.
+// An empty path is returned if no suitable location exists.
+std::filesystem::path GetCacheDirectory();
+// The per-user directory for settings files the user may edit, created on first use. Empty if there is none.
+std::filesystem::path GetConfigDirectory();
\ No newline at end of file
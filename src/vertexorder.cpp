@@ -0,0 +1,310 @@
+// SPDX-License-Identifier: GPL-3.0
+#include "vertexorder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+#include "parallel.h"
+
+// The entries of the simulated vertex cache, and the size Tipsify orders for. Real caches differ between GPUs, but an
+// order that suits a small FIFO suits them all.
+constexpr size_t VERTEX_CACHE_SIZE = 16;
+
+// The triangles each block of a model is optimised in, enough that little reuse is lost where blocks meet.
+constexpr size_t MODEL_BLOCK_TRIANGLES = 1 << 17;
+
+VertexCacheStats& VertexCacheStats::operator+=(const VertexCacheStats& other)
+{
+	transformed += other.transformed;
+	triangles += other.triangles;
+	vertices += other.vertices;
+
+	return *this;
+}
+
+double VertexCacheStats::GetAcmr() const
+{
+	return triangles == 0 ? 0.0 : static_cast<double>(transformed) / static_cast<double>(triangles);
+}
+
+double VertexCacheStats::GetAtvr() const
+{
+	return vertices == 0 ? 0.0 : static_cast<double>(transformed) / static_cast<double>(vertices);
+}
+
+template <typename Index>
+VertexCacheStats AnalyzeVertexCacheImpl(const Index* indices, const size_t indexCount, const size_t vertexCount)
+{
+	VertexCacheStats stats;
+	stats.triangles = indexCount / 3;
+
+	// The number of transforms when each vertex last entered the cache, zero if it never has. A vertex is still cached
+	// while fewer than the cache size have entered after it.
+	std::vector<size_t> entered(vertexCount, 0);
+
+	for (size_t index = 0; index < stats.triangles * 3; index++) {
+		const Index vertex = indices[index];
+
+		if (entered[vertex] != 0 && stats.transformed - entered[vertex] < VERTEX_CACHE_SIZE) {
+			continue;
+		}
+
+		stats.vertices += entered[vertex] == 0 ? 1 : 0;
+		stats.transformed++;
+		entered[vertex] = stats.transformed;
+	}
+
+	return stats;
+}
+
+VertexCacheStats AnalyzeVertexCache(const uint16_t* indices, const size_t indexCount, const size_t vertexCount)
+{
+	return AnalyzeVertexCacheImpl(indices, indexCount, vertexCount);
+}
+
+VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, const size_t indexCount, const size_t vertexCount)
+{
+	return AnalyzeVertexCacheImpl(indices, indexCount, vertexCount);
+}
+
+template <typename Index>
+void OptimizeVertexCacheImpl(Index* indices, const size_t indexCount, const size_t vertexCount)
+{
+	const size_t triangleCount = indexCount / 3;
+
+	if (triangleCount == 0 || vertexCount == 0) {
+		return;
+	}
+
+	// The triangles around each vertex, stored one vertex after another.
+	std::vector<uint32_t> adjacencyStart(vertexCount + 1, 0);
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+
+	for (size_t index = 0; index < triangleCount * 3; index++) {
+		adjacencyStart[indices[index] + 1]++;
+	}
+
+	for (size_t vertex = 0; vertex < vertexCount; vertex++) {
+		adjacencyStart[vertex + 1] += adjacencyStart[vertex];
+	}
+
+	// The triangles around each vertex not yet emitted, first used to fill the adjacency.
+	std::vector<uint32_t> live(adjacencyStart.begin(), adjacencyStart.end() - 1);
+
+	for (size_t index = 0; index < triangleCount * 3; index++) {
+		adjacency[live[indices[index]]++] = static_cast<uint32_t>(index / 3);
+	}
+
+	for (size_t vertex = 0; vertex < vertexCount; vertex++) {
+		live[vertex] = adjacencyStart[vertex + 1] - adjacencyStart[vertex];
+	}
+
+	std::vector<Index> output;
+	output.reserve(triangleCount * 3);
+
+	// The time each vertex last entered the cache, counted in vertices transformed.
+	std::vector<size_t> cacheTime(vertexCount, 0);
+	size_t time = VERTEX_CACHE_SIZE + 1;
+
+	std::vector<uint8_t> emitted(triangleCount, 0);
+	std::vector<Index> deadEnds;
+	std::vector<Index> candidates;
+	size_t cursor = 0;
+
+	int64_t fanning = 0;
+
+	while (fanning >= 0) {
+		candidates.clear();
+
+		// Emit every remaining triangle around the fanning vertex.
+		for (uint32_t entry = adjacencyStart[fanning]; entry < adjacencyStart[fanning + 1]; entry++) {
+			const uint32_t triangle = adjacency[entry];
+
+			if (emitted[triangle] != 0) {
+				continue;
+			}
+
+			for (size_t corner = 0; corner < 3; corner++) {
+				const Index vertex = indices[triangle * 3 + corner];
+
+				output.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				live[vertex]--;
+
+				if (time - cacheTime[vertex] > VERTEX_CACHE_SIZE) {
+					cacheTime[vertex] = time++;
+				}
+			}
+
+			emitted[triangle] = 1;
+		}
+
+		// Fan next around the candidate that stays in the cache the longest while its remaining triangles are
+		// emitted, as those would push it out.
+		fanning = -1;
+		size_t bestPriority = 0;
+
+		for (const Index vertex : candidates) {
+			if (live[vertex] == 0) {
+				continue;
+			}
+
+			const size_t age = time - cacheTime[vertex];
+			const size_t priority = age + 2 * live[vertex] <= VERTEX_CACHE_SIZE ? age : 0;
+
+			if (fanning < 0 || priority > bestPriority) {
+				fanning = vertex;
+				bestPriority = priority;
+			}
+		}
+
+		if (fanning >= 0) {
+			continue;
+		}
+
+		// At a dead end, continue from the most recently used vertex with triangles left, then from the lowest.
+		while (!deadEnds.empty() && fanning < 0) {
+			const Index vertex = deadEnds.back();
+			deadEnds.pop_back();
+
+			if (live[vertex] > 0) {
+				fanning = vertex;
+			}
+		}
+
+		while (cursor < vertexCount && fanning < 0) {
+			if (live[cursor] > 0) {
+				fanning = static_cast<int64_t>(cursor);
+			}
+
+			cursor++;
+		}
+	}
+
+	std::copy(output.begin(), output.end(), indices);
+}
+
+void OptimizeVertexCache(uint16_t* indices, const size_t indexCount, const size_t vertexCount)
+{
+	OptimizeVertexCacheImpl(indices, indexCount, vertexCount);
+}
+
+void OptimizeVertexCache(uint32_t* indices, const size_t indexCount, const size_t vertexCount)
+{
+	OptimizeVertexCacheImpl(indices, indexCount, vertexCount);
+}
+
+template <typename Index>
+void OptimizeVertexFetchImpl(Index* indices, const size_t indexCount, const size_t vertexCount,
+                             std::vector<uint32_t>& order)
+{
+	constexpr uint32_t unused = UINT32_MAX;
+
+	std::vector<uint32_t> remap(vertexCount, unused);
+	order.clear();
+	order.reserve(vertexCount);
+
+	for (size_t index = 0; index < indexCount; index++) {
+		uint32_t& target = remap[indices[index]];
+
+		if (target == unused) {
+			target = static_cast<uint32_t>(order.size());
+			order.push_back(static_cast<uint32_t>(indices[index]));
+		}
+
+		indices[index] = static_cast<Index>(target);
+	}
+
+	for (size_t vertex = 0; vertex < vertexCount; vertex++) {
+		if (remap[vertex] == unused) {
+			order.push_back(static_cast<uint32_t>(vertex));
+		}
+	}
+}
+
+void OptimizeVertexFetch(uint16_t* indices, const size_t indexCount, const size_t vertexCount,
+                         std::vector<uint32_t>& order)
+{
+	OptimizeVertexFetchImpl(indices, indexCount, vertexCount, order);
+}
+
+void OptimizeVertexFetch(uint32_t* indices, const size_t indexCount, const size_t vertexCount,
+                         std::vector<uint32_t>& order)
+{
+	OptimizeVertexFetchImpl(indices, indexCount, vertexCount, order);
+}
+
+void OptimizeModel(Model& model)
+{
+	const auto startTime = std::chrono::high_resolution_clock::now();
+
+	const size_t indexCount = model.indices.size() / 3 * 3;
+	const VertexCacheStats before = AnalyzeVertexCache(model.indices.data(), indexCount, model.vertices.size());
+
+	const size_t blockCount = (indexCount / 3 + MODEL_BLOCK_TRIANGLES - 1) / MODEL_BLOCK_TRIANGLES;
+
+	// Each block is optimised over only the vertices it uses, numbered locally to keep the work per block small. The
+	// numbering is one pass over the blocks in order, a vertex used by several is numbered in each.
+	std::vector<std::vector<uint32_t>> blockVertices(blockCount);
+	std::vector<uint32_t> vertexBlock(model.vertices.size(), UINT32_MAX);
+	std::vector<uint32_t> localIndex(model.vertices.size(), 0);
+
+	for (size_t block = 0; block < blockCount; block++) {
+		const size_t first = block * MODEL_BLOCK_TRIANGLES * 3;
+		const size_t last = std::min(first + MODEL_BLOCK_TRIANGLES * 3, indexCount);
+
+		for (size_t index = first; index < last; index++) {
+			const uint32_t vertex = model.indices[index];
+
+			if (vertexBlock[vertex] != block) {
+				vertexBlock[vertex] = static_cast<uint32_t>(block);
+				localIndex[vertex] = static_cast<uint32_t>(blockVertices[block].size());
+				blockVertices[block].push_back(vertex);
+			}
+
+			model.indices[index] = localIndex[vertex];
+		}
+	}
+
+	ParallelFor(blockCount, [&](const size_t begin, const size_t end) {
+		for (size_t block = begin; block < end; block++) {
+			const size_t first = block * MODEL_BLOCK_TRIANGLES * 3;
+			const size_t count = std::min(MODEL_BLOCK_TRIANGLES * 3, indexCount - first);
+			uint32_t* indices = model.indices.data() + first;
+
+			OptimizeVertexCache(indices, count, blockVertices[block].size());
+
+			for (size_t index = 0; index < count; index++) {
+				indices[index] = blockVertices[block][indices[index]];
+			}
+		}
+	});
+
+	std::vector<uint32_t> order;
+	OptimizeVertexFetch(model.indices.data(), indexCount, model.vertices.size(), order);
+
+	std::vector<Vertex> vertices(model.vertices.size());
+
+	ParallelFor(order.size(), [&](const size_t begin, const size_t end) {
+		for (size_t vertex = begin; vertex < end; vertex++) {
+			vertices[vertex] = model.vertices[order[vertex]];
+		}
+	});
+
+	model.vertices = std::move(vertices);
+
+	const VertexCacheStats after = AnalyzeVertexCache(model.indices.data(), indexCount, model.vertices.size());
+	const std::chrono::duration<double, std::milli> elapsedTime =
+		std::chrono::high_resolution_clock::now() - startTime;
+
+	ReportVertexOrder("Model", before, after, elapsedTime.count());
+}
+
+void ReportVertexOrder(const char* subject, const VertexCacheStats& before, const VertexCacheStats& after,
+                       const double milliseconds)
+{
+	std::cout << subject << " vertex order optimised in " << milliseconds << "ms, ACMR " << before.GetAcmr()
+	          << " -> " << after.GetAcmr() << ", ATVR " << before.GetAtvr() << " -> " << after.GetAtvr() << '\n';
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: GPL-3.0
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "declarations/structures.h"
+
+// How well an index order reuses the post-transform vertex cache of the GPU, simulated as a FIFO cache. The average
+// cache miss ratio (ACMR) is the vertices transformed per triangle, from 0.5 at best on a large grid to 3 at worst. The
+// average transform to vertex ratio (ATVR) is the vertices transformed per distinct vertex, 1 at best.
+struct VertexCacheStats {
+	size_t transformed = 0;
+	size_t triangles = 0;
+	size_t vertices = 0;
+
+	VertexCacheStats& operator+=(const VertexCacheStats& other);
+
+	[[nodiscard]] double GetAcmr() const;
+	[[nodiscard]] double GetAtvr() const;
+};
+
+VertexCacheStats AnalyzeVertexCache(const uint16_t* indices, size_t indexCount, size_t vertexCount);
+VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+// Reorder triangles so that vertices are reused while still in the vertex cache, following Tipsify (Sander, Nehab and
+// Barczak 2007), which fans around recently used vertices in linear time. Each triangle keeps its winding.
+void OptimizeVertexCache(uint16_t* indices, size_t indexCount, size_t vertexCount);
+void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+// Renumber vertices in the order the indices first use them, so they are fetched from memory front to back. The
+// previous number of each vertex is written to order at its new position, unused vertices are moved to the end.
+void OptimizeVertexFetch(uint16_t* indices, size_t indexCount, size_t vertexCount, std::vector<uint32_t>& order);
+void OptimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount, std::vector<uint32_t>& order);
+
+// Reorder the triangles and vertices of a whole model for the vertex cache, optimising blocks of triangles in
+// parallel. The surface is unchanged but the grid layout of a compiled mesh is lost, which G-code and mesh files rely
+// on, so this is only for copies written to formats read by renderers.
+void OptimizeModel(Model& model);
+
+// Write the statistics before and after reordering to the console.
+void ReportVertexOrder(const char* subject, const VertexCacheStats& before, const VertexCacheStats& after,
+                       double milliseconds);
\ No newline at end of file